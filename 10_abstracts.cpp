@@ -204,4 +204,1718 @@ for (int i = 0; i < 3; ++i) {
 for (int i = 0; i < 2; ++i) {
     delete drawables[i]; // (x) 인터페이스는 protected Non-Virtual 소멸자이기 때문에 다형 소멸을 제공하지 않습니다.
 }
-// C++20~: 컨셉 설계를 활용하여 마치 인터페이스처럼 컨셉에 의한 코딩 계약을 만들수 있습니다.
\ No newline at end of file
+// C++20~: 컨셉 설계를 활용하여 마치 인터페이스처럼 컨셉에 의한 코딩 계약을 만들수 있습니다.
+/*      ShapeStore - 타입별 구조체 배열 (Structure of Arrays)       */
+/*
+Shape* shapes[N] = { new Rectangle(), new Ellipse(), ... } 처럼 관리하면,
+    1. 도형마다 힙 할당이 1회씩 있고,
+    2. Draw() 호출마다 가상 함수 테이블을 거쳐 간접 호출하고,
+    3. m_Left/m_Top/m_Width/m_Height 가 힙 여기저기에 흩어져 있어 순회시 캐시 미스가 많습니다.
+
+도형이 아주 많고 주로 한꺼번에 그린다면, 타입별로 멤버 변수를 배열로 모아 둘수 있습니다.
+    (Array of Structures 대신 Structure of Arrays)
+
+    1. Columns 는 한 타입의 m_Left, m_Top, m_Width, m_Height 를 각각 std::vector 로 가집니다.
+    2. ShapeStore 는 Rectangle, Ellipse, Triangle 마다 Columns 를 1개씩 가집니다.
+    3. DrawAll() 은 타입별로 Columns 를 처음부터 끝까지 순회합니다. 타입이 정해져 있으므로 
+        가상 함수 호출이 없고, 메모리를 순서대로 읽으므로 캐시와 하드웨어 prefetch 가 잘 
+        동작하며, 컴파일러가 루프를 벡터화 할수도 있습니다.
+    4. 도형 1개를 다룰때는 ShapeHandle (타입 + 인덱스) 을 사용합니다. Shape 처럼 
+        GetLeft(), SetWidth(), Draw() 등을 제공합니다.
+    5. 측정을 위해 Draw() 는 출력 대신 DrawContext 에 덮은 픽셀 수를 누적합니다.
+        (std::cout 출력은 측정을 왜곡합니다.)
+
+(~) 주의. 새로운 도형 타입을 추가하려면 ShapeStore 를 수정해야 합니다. 타입이 정해진 
+    경우에만 사용하세요. 또한 도형을 삭제하면 인덱스가 바뀌므로 ShapeHandle 이 무효화될수 
+    있습니다. 여기서는 추가만 지원합니다.
+*/
+#include <cstdint>
+#include <vector>
+
+enum ShapeType {
+    ShapeType_Rectangle,
+    ShapeType_Ellipse,
+    ShapeType_Triangle,
+    ShapeType_Count
+};
+
+// #5. 덮은 픽셀 수를 누적합니다.
+struct DrawContext {
+    std::int64_t m_Pixels;
+    DrawContext() : m_Pixels(0) {}
+};
+
+// 타입별로 그리는 함수 입니다. ShapeStore 와 기존 Shape 계층이 같이 사용합니다.
+inline void DrawRectangle(DrawContext& context, int left, int top, int width, int height) {
+    context.m_Pixels += static_cast<std::int64_t>(width) * height;
+}
+inline void DrawEllipse(DrawContext& context, int left, int top, int width, int height) {
+    context.m_Pixels += static_cast<std::int64_t>(width) * height * 785 / 1000; // 대략 π/4
+}
+inline void DrawTriangle(DrawContext& context, int left, int top, int width, int height) {
+    context.m_Pixels += static_cast<std::int64_t>(width) * height / 2;
+}
+
+class ShapeStore {
+public:
+    // #1. 한 타입의 멤버 변수들을 배열로 가집니다.
+    struct Columns {
+        std::vector<int> m_Left;
+        std::vector<int> m_Top;
+        std::vector<int> m_Width;
+        std::vector<int> m_Height;
+
+        std::size_t GetSize() const { return m_Left.size(); }
+        void Reserve(std::size_t count) {
+            m_Left.reserve(count); m_Top.reserve(count); m_Width.reserve(count); m_Height.reserve(count);
+        }
+    };
+
+    // #4. 도형 1개에 접근합니다. Shape* 대신 값으로 복사해서 사용합니다.
+    class ShapeHandle {
+        ShapeStore* m_Store;
+        ShapeType m_Type;
+        std::uint32_t m_Index;
+    public:
+        ShapeHandle(ShapeStore* store, ShapeType type, std::uint32_t index) :
+            m_Store(store),
+            m_Type(type),
+            m_Index(index) {}
+
+        ShapeType GetType() const { return m_Type; }
+        int GetLeft() const { return GetColumns().m_Left[m_Index]; }
+        int GetTop() const { return GetColumns().m_Top[m_Index]; }
+        int GetWidth() const { return GetColumns().m_Width[m_Index]; }
+        int GetHeight() const { return GetColumns().m_Height[m_Index]; }
+        void SetLeft(int val) { GetColumns().m_Left[m_Index] = val; }
+        void SetTop(int val) { GetColumns().m_Top[m_Index] = val; }
+        void SetWidth(int val) { GetColumns().m_Width[m_Index] = val; }
+        void SetHeight(int val) { GetColumns().m_Height[m_Index] = val; }
+
+        // 도형 1개를 그릴때는 타입으로 분기합니다.
+        void Draw(DrawContext& context) const {
+            const Columns& c = GetColumns();
+            switch (m_Type) {
+            case ShapeType_Rectangle: DrawRectangle(context, c.m_Left[m_Index], c.m_Top[m_Index], c.m_Width[m_Index], c.m_Height[m_Index]); break;
+            case ShapeType_Ellipse: DrawEllipse(context, c.m_Left[m_Index], c.m_Top[m_Index], c.m_Width[m_Index], c.m_Height[m_Index]); break;
+            case ShapeType_Triangle: DrawTriangle(context, c.m_Left[m_Index], c.m_Top[m_Index], c.m_Width[m_Index], c.m_Height[m_Index]); break;
+            default: break;
+            }
+        }
+    private:
+        const Columns& GetColumns() const { return m_Store->m_Columns[m_Type]; }
+        Columns& GetColumns() { return m_Store->m_Columns[m_Type]; }
+    };
+private:
+    Columns m_Columns[ShapeType_Count]; // #2
+
+    // #3. 타입이 정해진 함수로 한 타입의 Columns 를 순회합니다.
+    template<typename DrawFunc>
+    static void DrawColumns(DrawContext& context, const Columns& c, DrawFunc drawFunc) {
+        const int* left = c.m_Left.data();
+        const int* top = c.m_Top.data();
+        const int* width = c.m_Width.data();
+        const int* height = c.m_Height.data();
+        const std::size_t size = c.GetSize();
+        for (std::size_t i = 0; i < size; ++i) {
+            drawFunc(context, left[i], top[i], width[i], height[i]); // 인라인됩니다.
+        }
+    }
+public:
+    ShapeHandle Add(ShapeType type, int left, int top, int width, int height) {
+        Columns& c = m_Columns[type];
+        c.m_Left.push_back(left);
+        c.m_Top.push_back(top);
+        c.m_Width.push_back(width);
+        c.m_Height.push_back(height);
+        return ShapeHandle(this, type, static_cast<std::uint32_t>(c.GetSize() - 1));
+    }
+    void Reserve(ShapeType type, std::size_t count) { m_Columns[type].Reserve(count); }
+    std::size_t GetSize(ShapeType type) const { return m_Columns[type].GetSize(); }
+    const Columns& GetColumns(ShapeType type) const { return m_Columns[type]; }
+    ShapeHandle Get(ShapeType type, std::uint32_t index) { return ShapeHandle(this, type, index); }
+
+    // #3. 타입별로 한꺼번에 그립니다.
+    void DrawAll(DrawContext& context) const {
+        DrawColumns(context, m_Columns[ShapeType_Rectangle], &DrawRectangle);
+        DrawColumns(context, m_Columns[ShapeType_Ellipse], &DrawEllipse);
+        DrawColumns(context, m_Columns[ShapeType_Triangle], &DrawTriangle);
+    }
+};
+
+{
+    ShapeStore store;
+    ShapeStore::ShapeHandle rect = store.Add(ShapeType_Rectangle, 0, 0, 10, 20);
+    store.Add(ShapeType_Ellipse, 5, 5, 10, 10);
+    store.Add(ShapeType_Triangle, 1, 1, 4, 4);
+
+    rect.SetWidth(20);  // (0) Shape 처럼 도형 1개를 수정할수 있습니다.
+    EXPECT_TRUE(store.Get(ShapeType_Rectangle, 0).GetWidth() == 20);
+
+    DrawContext context;
+    store.DrawAll(context);
+    EXPECT_TRUE(context.m_Pixels == 20 * 20 + 10 * 10 * 785 / 1000 + 4 * 4 / 2);
+}
+// (~) 주의. 그리기 순서가 타입별로 바뀝니다. 도형이 겹쳐 그리기 순서가 중요하다면 
+//  ShapeStore 를 그대로 사용할수 없습니다. (멀티 쓰레드 타일 렌더러 참고)
+
+/*      Shape* 배열과 ShapeStore 측정       */
+// 기존 Shape 계층은 Draw(DrawContext&) 에서 같은 DrawRectangle() 등을 호출하도록 하고, 
+//  타입을 무작위로 섞어 new 로 생성합니다. (실제 프로그램처럼 힙에 흩어지게 됩니다.)
+#include <chrono>
+#include <cstdlib>
+
+const int counts[] = { 1000000, 10000000 };
+for (int count : counts) {
+    std::vector<Shape*> shapes;
+    ShapeStore store;
+    shapes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int left = std::rand() % 1000, top = std::rand() % 1000, width = std::rand() % 100, height = std::rand() % 100;
+        switch (std::rand() % ShapeType_Count) {
+        case ShapeType_Rectangle: shapes.push_back(new Rectangle(left, top, width, height)); store.Add(ShapeType_Rectangle, left, top, width, height); break;
+        case ShapeType_Ellipse: shapes.push_back(new Ellipse(left, top, width, height)); store.Add(ShapeType_Ellipse, left, top, width, height); break;
+        default: shapes.push_back(new Triangle(left, top, width, height)); store.Add(ShapeType_Triangle, left, top, width, height); break;
+        }
+    }
+
+    DrawContext pointerContext;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < shapes.size(); ++i) {
+        shapes[i]->Draw(pointerContext); // 가상 함수 호출 + 흩어진 메모리 접근
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    DrawContext storeContext;
+    store.DrawAll(storeContext);         // 타입별 순차 접근
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    EXPECT_TRUE(pointerContext.m_Pixels == storeContext.m_Pixels); // 같은 결과여야 합니다.
+    std::cout << "count: " << count
+        << " Shape* ns/shape: " << std::chrono::duration<double, std::nano>(mid - begin).count() / count
+        << " ShapeStore ns/shape: " << std::chrono::duration<double, std::nano>(end - mid).count() / count
+        << std::endl;
+
+    for (std::size_t i = 0; i < shapes.size(); ++i) {
+        delete shapes[i];
+    }
+}
+// 10^7 개이면 Shape* 쪽은 힙 사용량이 캐시보다 훨씬 커서 메모리 대기 시간이 대부분이 됩니다.
+//  ShapeStore 는 도형당 16byte 만 순서대로 읽으므로 메모리 대역폭 한계까지 빨라질수 있습니다.
+
+/*      ShapeVariant - std::variant 를 이용한 닫힌 도형 계층        */
+/*
+Shape::Draw() 는 순가상 함수여서 Shape* 로 호출하면 어떤 함수가 호출될지 컴파일 타임에 
+    알수 없어 인라인되지 않고, 다형적으로 사용하려면 new 로 생성해야 합니다.
+
+Rectangle, Ellipse, Triangle 외에 다른 도형이 추가되지 않는 닫힌 계층이라면, 
+    C++17~ 의 std::variant 로 값 타입처럼 다룰수 있습니다.
+    1. 각 도형은 Shape 를 상속하지 않는 값 타입입니다. 가상 함수도, 가상 소멸자도 없습니다.
+    2. ShapeVariant 는 셋중 하나를 개체 내부에 보관합니다. 크기는 가장 큰 도형 + 타입 인덱스
+        입니다. 힙 할당이 없습니다.
+    3. Draw() 는 std::visit 으로 실제 타입의 Draw() 를 호출합니다. 컴파일러는 타입별 
+        호출을 모두 알고 있으므로 인라인할수 있습니다.
+    4. 복사는 std::variant 의 복사 생성자가 실제 타입의 복사 생성자를 호출하므로, 가상 복사 
+        생성자 (Clone()) 가 필요 없습니다.
+    5. std::vector<ShapeVariant> 에 연속으로 저장됩니다.
+
+(~) 주의. 도형 타입을 추가하면 ShapeVariant 를 사용하는 모든 코드를 다시 컴파일해야 합니다. 
+    또한 가장 큰 도형의 크기만큼 공간을 차지하므로, 도형간 크기 차이가 크면 낭비가 큽니다.
+*/
+#include <variant>
+#include <vector>
+
+// #1. 상속 없는 값 타입 도형들 입니다. 모든 도형은 왼쪽 상단 좌표와 크기를 가집니다.
+class Rectangle {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+public:
+    Rectangle(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    void Draw(DrawContext& context) const { DrawRectangle(context, m_Left, m_Top, m_Width, m_Height); }
+};
+class Ellipse {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+public:
+    Ellipse(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    void Draw(DrawContext& context) const { DrawEllipse(context, m_Left, m_Top, m_Width, m_Height); }
+};
+class Triangle {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+public:
+    Triangle(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    void Draw(DrawContext& context) const { DrawTriangle(context, m_Left, m_Top, m_Width, m_Height); }
+};
+
+// #2.
+class ShapeVariant {
+    std::variant<Rectangle, Ellipse, Triangle> m_Shape;
+public:
+    template<typename U>
+    ShapeVariant(const U& shape) : m_Shape(shape) {} // Rectangle, Ellipse, Triangle 만 가능합니다.
+
+    // #4. 암시적 복사 생성자, 복사 대입 연산자가 실제 타입을 복사합니다.
+
+    // #3. 실제 타입의 Draw() 를 호출합니다.
+    void Draw(DrawContext& context) const {
+        std::visit([&context](const auto& shape) { shape.Draw(context); }, m_Shape);
+    }
+    std::size_t GetTypeIndex() const { return m_Shape.index(); }
+
+    template<typename U>
+    bool Is() const { return std::holds_alternative<U>(m_Shape); }
+};
+
+{
+    std::vector<ShapeVariant> shapes; // #5. 연속된 메모리에 값으로 저장합니다.
+    shapes.push_back(Rectangle(0, 0, 10, 20));
+    shapes.push_back(Ellipse(5, 5, 10, 10));
+    shapes.push_back(Triangle(1, 1, 4, 4));
+
+    std::vector<ShapeVariant> clones(shapes); // (0) #4. Clone() 없이 실제 타입으로 복사됩니다.
+    EXPECT_TRUE(clones[0].Is<Rectangle>() && clones[1].Is<Ellipse>() && clones[2].Is<Triangle>());
+
+    DrawContext context;
+    for (std::size_t i = 0; i < clones.size(); ++i) {
+        clones[i].Draw(context);
+    }
+    EXPECT_TRUE(context.m_Pixels == 10 * 20 + 10 * 10 * 785 / 1000 + 4 * 4 / 2);
+}
+// delete 할 필요가 없습니다. std::vector 가 소멸되면 도형들도 소멸됩니다.
+
+/*      가상 함수, std::visit, switch 측정      */
+// 같은 도형들을 3가지 방식으로 그립니다.
+//  1. 가상 함수 : std::vector<Shape*> 와 virtual Draw(DrawContext&) (ShapeStore 측정의 Shape 계층)
+//      값 타입 도형과 이름이 겹치므로 ShapeRectangle, ShapeEllipse, ShapeTriangle 이라 하겠습니다.
+//  2. std::visit : std::vector<ShapeVariant>
+//  3. switch : std::vector<ShapeRecord>. ShapeRecord 는 타입 인덱스와 좌표/크기를 가진 구조체이고
+//      switch 로 DrawRectangle() 등을 직접 호출합니다.
+#include <chrono>
+#include <cstdlib>
+
+struct ShapeRecord {
+    ShapeType m_Type;
+    int m_Left, m_Top, m_Width, m_Height;
+};
+
+template<typename Func>
+double MeasureNs(Func func) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+}
+
+const int count = 1000000;
+std::vector<Shape*> pointers;
+std::vector<ShapeVariant> variants;
+std::vector<ShapeRecord> records;
+for (int i = 0; i < count; ++i) {
+    ShapeRecord r = { static_cast<ShapeType>(std::rand() % ShapeType_Count), 
+        std::rand() % 1000, std::rand() % 1000, std::rand() % 100, std::rand() % 100 };
+    records.push_back(r);
+    switch (r.m_Type) {
+    case ShapeType_Rectangle: 
+        pointers.push_back(new ShapeRectangle(r.m_Left, r.m_Top, r.m_Width, r.m_Height)); // Shape 계층의 Rectangle
+        variants.push_back(Rectangle(r.m_Left, r.m_Top, r.m_Width, r.m_Height));      // 값 타입 Rectangle
+        break;
+    case ShapeType_Ellipse: 
+        pointers.push_back(new ShapeEllipse(r.m_Left, r.m_Top, r.m_Width, r.m_Height));
+        variants.push_back(Ellipse(r.m_Left, r.m_Top, r.m_Width, r.m_Height));
+        break;
+    default:
+        pointers.push_back(new ShapeTriangle(r.m_Left, r.m_Top, r.m_Width, r.m_Height));
+        variants.push_back(Triangle(r.m_Left, r.m_Top, r.m_Width, r.m_Height));
+        break;
+    }
+}
+
+DrawContext c1, c2, c3;
+double virtualNs = MeasureNs([&]() { for (Shape* shape : pointers) shape->Draw(c1); });
+double visitNs = MeasureNs([&]() { for (const ShapeVariant& shape : variants) shape.Draw(c2); });
+double switchNs = MeasureNs([&]() {
+    for (const ShapeRecord& r : records) {
+        switch (r.m_Type) {
+        case ShapeType_Rectangle: DrawRectangle(c3, r.m_Left, r.m_Top, r.m_Width, r.m_Height); break;
+        case ShapeType_Ellipse: DrawEllipse(c3, r.m_Left, r.m_Top, r.m_Width, r.m_Height); break;
+        default: DrawTriangle(c3, r.m_Left, r.m_Top, r.m_Width, r.m_Height); break;
+        }
+    }
+});
+EXPECT_TRUE(c1.m_Pixels == c2.m_Pixels && c2.m_Pixels == c3.m_Pixels);
+
+std::cout << "virtual ns/shape: " << virtualNs / count
+    << " std::visit ns/shape: " << visitNs / count
+    << " switch ns/shape: " << switchNs / count << std::endl;
+
+for (Shape* shape : pointers) delete shape;
+// 타입이 무작위로 섞여 있으므로 3가지 모두 분기 예측 실패가 있습니다. 차이는 주로
+//  힙에 흩어진 개체 접근 (가상 함수)과 인라인 가능 여부에서 납니다.
+//  std::visit 은 대부분의 컴파일러에서 switch 와 비슷한 점프 테이블로 컴파일됩니다.
+
+/*      소프트웨어 래스터라이저 - Rectangle::Draw(), Ellipse::Draw() 구현      */
+/*
+지금까지 Rectangle::Draw(), Ellipse::Draw() 는 이름만 출력했습니다. 다음은 실제로 메모리상의
+    RGBA 프레임 버퍼에 m_Left/m_Top/m_Width/m_Height 영역을 칠하는 구현입니다.
+
+    1. FrameBuffer 는 가로 m_Width, 세로 m_Height 의 32bit RGBA 픽셀 배열입니다. 
+        한 행 (scanline) 은 메모리상 연속입니다.
+    2. 도형은 한 행에서 연속된 구간 (span) 의 합으로 그립니다. FillSpan() 은 SIMD 로 
+        여러 픽셀을 한번에 씁니다. (AVX2 는 8픽셀, SSE2 는 4픽셀. 둘다 없으면 1픽셀씩)
+    3. Rectangle 은 모든 행이 같은 span 이므로, 프레임 버퍼 밖을 잘라낸 뒤 행마다 
+        FillSpan() 만 호출합니다.
+    4. Ellipse 는 픽셀 중심이 타원 내부에 있으면 칠합니다. 2배 확대한 정수 좌표로 계산하여
+        오차가 없습니다.
+            X = 2 * (x - left) + 1 - width, Y = 2 * (y - top) + 1 - height 일때,
+            X^2 * height^2 + Y^2 * width^2 <= width^2 * height^2 이면 내부
+        행마다 모든 픽셀을 검사하지 않고, 이전 행의 span 시작점에서 출발해 늘리거나 
+        줄이기만 합니다. (incremental scanline) span 시작점은 위쪽 절반에서는 왼쪽으로만, 
+        아래쪽 절반에서는 오른쪽으로만 움직이므로, 전체 검사 횟수는 width + height 에 비례합니다.
+    5. 타원은 좌우 대칭이므로 span 의 시작점만 구하면 끝점은 width - 1 - 시작점 입니다.
+    6. 검사식의 각 항은 최대 width^2 * height^2 정도이므로, std::int64_t 로 계산할때 
+        width, height 는 각각 2^15 (32768) 이하여야 합니다. 이보다 큰 타원은 그리지 않습니다.
+*/
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// #1.
+class FrameBuffer {
+    int m_Width;
+    int m_Height;
+    std::vector<std::uint32_t> m_Pixels;
+public:
+    FrameBuffer(int width, int height) :
+        m_Width(width),
+        m_Height(height),
+        m_Pixels(static_cast<std::size_t>(width) * height, 0) {}
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    std::uint32_t* GetRow(int y) { return &m_Pixels[static_cast<std::size_t>(y) * m_Width]; }
+    const std::uint32_t* GetRow(int y) const { return &m_Pixels[static_cast<std::size_t>(y) * m_Width]; }
+    std::uint32_t GetPixel(int x, int y) const { return GetRow(y)[x]; }
+    void Clear(std::uint32_t color) { m_Pixels.assign(m_Pixels.size(), color); }
+    bool operator ==(const FrameBuffer& other) const { 
+        return m_Width == other.m_Width && m_Height == other.m_Height && m_Pixels == other.m_Pixels; 
+    }
+};
+
+// #2. row[x0, x1) 를 color 로 칠합니다. 0 <= x0 <= x1 <= 행 너비 여야 합니다.
+inline void FillSpan(std::uint32_t* row, int x0, int x1, std::uint32_t color) {
+    int x = x0;
+#if defined(__AVX2__)
+    const __m256i colors = _mm256_set1_epi32(static_cast<int>(color));
+    for (; x + 8 <= x1; x += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + x), colors);
+    }
+#elif defined(__SSE2__)
+    const __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+    for (; x + 4 <= x1; x += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), colors);
+    }
+#endif
+    for (; x < x1; ++x) { // 나머지 픽셀
+        row[x] = color;
+    }
+}
+
+class Shape {
+    // 모든 도형은 왼쪽 상단 좌표와 크기, 색상을 가집니다.
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+    std::uint32_t m_Color;
+private:
+    Shape(const Shape& other) {}
+    Shape& operator =(const Shape& other) { return *this; }
+protected:
+    Shape(int l, int t, int w, int h, std::uint32_t color) :
+        m_Left(l), m_Top(t), m_Width(w), m_Height(h), m_Color(color) {}
+public:
+    virtual ~Shape() {}
+    virtual void Draw(FrameBuffer& frameBuffer) const = 0;
+
+    int GetLeft() const { return m_Left; }
+    int GetTop() const { return m_Top; }
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    std::uint32_t GetColor() const { return m_Color; }
+};
+
+class Rectangle : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+
+    // #3. 프레임 버퍼 밖을 잘라낸 뒤 행마다 같은 span 을 칠합니다.
+    virtual void Draw(FrameBuffer& frameBuffer) const {
+        int x0 = std::max(GetLeft(), 0);
+        int y0 = std::max(GetTop(), 0);
+        int x1 = std::min(GetLeft() + GetWidth(), frameBuffer.GetWidth());
+        int y1 = std::min(GetTop() + GetHeight(), frameBuffer.GetHeight());
+        if (x0 >= x1) return;
+
+        for (int y = y0; y < y1; ++y) {
+            FillSpan(frameBuffer.GetRow(y), x0, x1, GetColor());
+        }
+    }
+};
+
+class Ellipse : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+
+    // #6. IsInside() 가 std::int64_t 범위를 넘지 않는 최대 크기 입니다.
+    static constexpr int MaxSize = 1 << 15;
+
+    // #4. i 번째 열의 픽셀 중심이 Y 행에서 타원 내부에 있는지 검사합니다.
+    //  w, h 는 MaxSize 이하여야 합니다.
+    static bool IsInside(std::int64_t i, std::int64_t Y, std::int64_t w, std::int64_t h) {
+        std::int64_t X = 2 * i + 1 - w;
+        return X * X * h * h + Y * Y * w * w <= w * w * h * h;
+    }
+
+    // #4, #5. 이전 행의 span 시작점에서 출발하여 행마다 조금씩 조정합니다.
+    virtual void Draw(FrameBuffer& frameBuffer) const {
+        const int w = GetWidth();
+        const int h = GetHeight();
+        if (w <= 0 || h <= 0) return;
+        if (w > MaxSize || h > MaxSize) return; // #6. 그리지 않습니다.
+
+        const int last = (w - 1) / 2;   // span 시작점의 최대값 (가운데 열)
+        int start = last + 1;           // 처음에는 빈 span 입니다.
+        int y0 = std::max(GetTop(), 0);
+        int y1 = std::min(GetTop() + h, frameBuffer.GetHeight());
+
+        // 위쪽이 잘렸다면 잘린 행까지는 span 을 그리지 않고 시작점만 갱신합니다.
+        for (int y = GetTop(); y < y1; ++y) {
+            const std::int64_t Y = 2 * static_cast<std::int64_t>(y - GetTop()) + 1 - h;
+            while (start <= last && !IsInside(start, Y, w, h)) ++start; // 아래쪽 절반: 줄어듭니다.
+            while (start > 0 && IsInside(start - 1, Y, w, h)) --start;  // 위쪽 절반: 늘어납니다.
+            if (y < y0 || start > last) continue;
+
+            int x0 = std::max(GetLeft() + start, 0);
+            int x1 = std::min(GetLeft() + w - start, frameBuffer.GetWidth());
+            if (x0 < x1) {
+                FillSpan(frameBuffer.GetRow(y), x0, x1, GetColor());
+            }
+        }
+    }
+};
+// (~) 주의. 위쪽으로 많이 벗어난 타원은 잘린 행들도 시작점 갱신을 위해 순회합니다. 
+//  화면 밖 행이 많다면 첫 보이는 행의 시작점을 이분 탐색으로 구하도록 개선할수 있습니다.
+
+/*      래스터라이저 회귀 시험 - 픽셀 단위 비교     */
+// 최적화된 Draw() 결과를, 모든 픽셀을 정의대로 검사하는 느린 참조 구현의 결과와 
+//  픽셀 단위로 비교합니다. 잘림, 홀수/짝수 크기, 크기 0, 1 같은 경계 조건을 포함합니다.
+#include <cstdlib>
+
+void DrawReference(FrameBuffer& frameBuffer, const Shape& shape, bool isEllipse) {
+    for (int y = 0; y < frameBuffer.GetHeight(); ++y) {
+        for (int x = 0; x < frameBuffer.GetWidth(); ++x) {
+            int i = x - shape.GetLeft();
+            int j = y - shape.GetTop();
+            if (i < 0 || j < 0 || i >= shape.GetWidth() || j >= shape.GetHeight()) continue;
+            if (isEllipse && !Ellipse::IsInside(i, 2 * j + 1 - shape.GetHeight(), shape.GetWidth(), shape.GetHeight())) continue;
+            frameBuffer.GetRow(y)[x] = shape.GetColor();
+        }
+    }
+}
+
+{
+    // 정해진 경계 조건들
+    FrameBuffer fb(8, 8);
+    Ellipse(0, 0, 1, 1, 0xFFFFFFFF).Draw(fb);
+    EXPECT_TRUE(fb.GetPixel(0, 0) == 0xFFFFFFFF);  // 1x1 타원은 픽셀 1개 입니다.
+    Ellipse(2, 2, 0, 5, 0xFF0000FF).Draw(fb);       // 크기 0은 그리지 않습니다.
+    Rectangle(-3, 6, 5, 10, 0xFF00FF00).Draw(fb);   // 왼쪽, 아래쪽이 잘립니다.
+    EXPECT_TRUE(fb.GetPixel(1, 7) == 0xFF00FF00 && fb.GetPixel(2, 7) == 0);
+
+    // 무작위 도형들
+    std::srand(1);
+    for (int n = 0; n < 1000; ++n) {
+        FrameBuffer actual(64, 48);
+        FrameBuffer expected(64, 48);
+        int l = std::rand() % 96 - 16, t = std::rand() % 80 - 16;
+        int w = std::rand() % 70, h = std::rand() % 70;
+        std::uint32_t color = static_cast<std::uint32_t>(std::rand()) | 0xFF000000;
+
+        Ellipse ellipse(l, t, w, h, color);
+        ellipse.Draw(actual);
+        DrawReference(expected, ellipse, true);
+        EXPECT_TRUE(actual == expected);
+
+        Rectangle rect(t, l, h, w, color);
+        rect.Draw(actual);
+        DrawReference(expected, rect, false);
+        EXPECT_TRUE(actual == expected);
+    }
+}
+
+/*      래스터라이저 처리량 측정 (shapes/s, Mpixel/s)      */
+#include <chrono>
+
+void MeasureRaster(const char* name, const std::vector<Shape*>& shapes, FrameBuffer& frameBuffer) {
+    // 칠한 픽셀 수는 잘림을 고려해야 하므로 참조 구현 대신 도형 면적의 합으로 근사합니다.
+    double pixels = 0;
+    for (const Shape* shape : shapes) pixels += static_cast<double>(shape->GetWidth()) * shape->GetHeight();
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (const Shape* shape : shapes) shape->Draw(frameBuffer);
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << name << " shapes/s: " << shapes.size() / sec 
+        << " Mpixel/s: " << pixels / sec / 1e6 << " (bounding box 기준)" << std::endl;
+}
+
+FrameBuffer frameBuffer(1920, 1080);
+const int sizes[] = { 8, 64, 512 };
+for (int size : sizes) {
+    std::vector<Shape*> rects;
+    std::vector<Shape*> ellipses;
+    for (int i = 0; i < 100000; ++i) {
+        int l = std::rand() % (1920 - size), t = std::rand() % (1080 - size);
+        rects.push_back(new Rectangle(l, t, size, size, 0xFF0000FF));
+        ellipses.push_back(new Ellipse(l, t, size, size, 0xFF00FF00));
+    }
+    std::cout << "size: " << size << std::endl;
+    MeasureRaster("Rectangle", rects, frameBuffer);
+    MeasureRaster("Ellipse", ellipses, frameBuffer);
+    for (Shape* shape : rects) delete shape;
+    for (Shape* shape : ellipses) delete shape;
+}
+// 작은 도형은 도형당 고정 비용 (가상 함수 호출, 잘라내기) 이, 큰 도형은 FillSpan() 의 
+//  메모리 쓰기 대역폭이 처리량을 결정합니다.
+
+/*      멀티 쓰레드 타일 렌더러       */
+/*
+for (i...) shapes[i]->Draw() 는 CPU 코어 1개만 사용합니다. 화면을 타일로 나누면 
+    서로 다른 타일은 다른 픽셀을 쓰므로 여러 쓰레드에서 동시에 그릴수 있습니다.
+
+    1. Draw() 에 ClipRect 를 전달하여, 도형을 타일 영역 안쪽만 그리게 합니다. 
+        (래스터라이저의 Draw() 에서 프레임 버퍼 경계 대신 ClipRect 로 잘라냅니다.)
+    2. Binning : 도형들을 원래 순서대로 순회하면서, bounding box 가 겹치는 타일마다 
+        도형 인덱스를 추가합니다. 따라서 각 타일의 목록도 원래 순서를 유지합니다.
+    3. 타일마다 자신의 목록을 순서대로 그립니다. 한 픽셀을 덮는 도형들은 모두 같은 타일 
+        목록에 원래 순서대로 있으므로, 겹친 도형의 결과가 단일 쓰레드와 픽셀 단위로 같습니다.
+    4. 타일마다 도형 수가 크게 다르므로 (화면 가운데에 몰려 있는 등), 타일을 쓰레드에 미리 
+        나눠 주면 일찍 끝난 쓰레드가 놀게 됩니다. WorkStealingPool 은 쓰레드마다 작업 큐를 
+        두고, 자신의 큐가 비면 다른 쓰레드의 큐에서 작업을 훔쳐옵니다. 
+        쓰레드는 생성자에서 1번 만들어 두고, Run() 마다 condition_variable 로 깨워 작업을 
+        나눠 주며, 소멸자에서 join 합니다. 프레임마다 쓰레드를 생성/소멸하지 않습니다.
+*/
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct ClipRect {
+    int m_Left;
+    int m_Top;
+    int m_Right;    // 포함하지 않습니다.
+    int m_Bottom;   // 포함하지 않습니다.
+};
+
+class Shape {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+    std::uint32_t m_Color;
+private:
+    Shape(const Shape& other) {}
+    Shape& operator =(const Shape& other) { return *this; }
+protected:
+    Shape(int l, int t, int w, int h, std::uint32_t color) :
+        m_Left(l), m_Top(t), m_Width(w), m_Height(h), m_Color(color) {}
+public:
+    virtual ~Shape() {}
+    // #1. clip 영역 안쪽만 그립니다.
+    virtual void Draw(FrameBuffer& frameBuffer, const ClipRect& clip) const = 0;
+    void Draw(FrameBuffer& frameBuffer) const {
+        ClipRect all = { 0, 0, frameBuffer.GetWidth(), frameBuffer.GetHeight() };
+        Draw(frameBuffer, all);
+    }
+
+    int GetLeft() const { return m_Left; }
+    int GetTop() const { return m_Top; }
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    std::uint32_t GetColor() const { return m_Color; }
+};
+
+class Rectangle : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+    virtual void Draw(FrameBuffer& frameBuffer, const ClipRect& clip) const {
+        int x0 = std::max(GetLeft(), clip.m_Left);
+        int y0 = std::max(GetTop(), clip.m_Top);
+        int x1 = std::min(GetLeft() + GetWidth(), clip.m_Right);
+        int y1 = std::min(GetTop() + GetHeight(), clip.m_Bottom);
+        if (x0 >= x1) return;
+        for (int y = y0; y < y1; ++y) {
+            FillSpan(frameBuffer.GetRow(y), x0, x1, GetColor());
+        }
+    }
+};
+
+class Ellipse : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+    static constexpr int MaxSize = 1 << 15; // IsInside() 가 std::int64_t 범위를 넘지 않는 최대 크기
+    static bool IsInside(std::int64_t i, std::int64_t Y, std::int64_t w, std::int64_t h) {
+        std::int64_t X = 2 * i + 1 - w;
+        return X * X * h * h + Y * Y * w * w <= w * w * h * h;
+    }
+    virtual void Draw(FrameBuffer& frameBuffer, const ClipRect& clip) const {
+        const int w = GetWidth();
+        const int h = GetHeight();
+        if (w <= 0 || h <= 0) return;
+        if (w > MaxSize || h > MaxSize) return; // #6. 그리지 않습니다.
+
+        const int last = (w - 1) / 2;
+        int start = last + 1;
+        int y0 = std::max(GetTop(), clip.m_Top);
+        int y1 = std::min(GetTop() + h, clip.m_Bottom);
+        for (int y = GetTop(); y < y1; ++y) {
+            const std::int64_t Y = 2 * static_cast<std::int64_t>(y - GetTop()) + 1 - h;
+            while (start <= last && !IsInside(start, Y, w, h)) ++start;
+            while (start > 0 && IsInside(start - 1, Y, w, h)) --start;
+            if (y < y0 || start > last) continue;
+
+            int x0 = std::max(GetLeft() + start, clip.m_Left);
+            int x1 = std::min(GetLeft() + w - start, clip.m_Right);
+            if (x0 < x1) {
+                FillSpan(frameBuffer.GetRow(y), x0, x1, GetColor());
+            }
+        }
+    }
+};
+
+// #4. 쓰레드마다 작업 큐를 가지고, 비면 다른 쓰레드의 큐에서 훔쳐옵니다.
+class WorkStealingPool {
+    struct Queue {
+        std::mutex m_Mutex;
+        std::deque<int> m_Tasks;
+    };
+    int m_ThreadCount;
+    std::vector<Queue> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_Mutex;                         // 아래 멤버들을 보호합니다.
+    std::condition_variable m_Started;          // m_Generation 이 증가하거나 m_Stop 이면 알립니다.
+    std::condition_variable m_Finished;         // m_Running 이 0 이 되면 알립니다.
+    const std::function<void(int)>* m_Func;
+    unsigned m_Generation;                      // Run() 마다 증가합니다.
+    int m_Running;                              // 작업중인 쓰레드 수
+    bool m_Stop;
+public:
+    // 쓰레드들은 생성자에서 1번 만들고, Run() 을 기다립니다. 쓰레드는 최소 1개 입니다.
+    explicit WorkStealingPool(int threadCount) : 
+        m_ThreadCount(std::max(threadCount, 1)), 
+        m_Queues(m_ThreadCount), 
+        m_Func(nullptr), 
+        m_Generation(0), 
+        m_Running(0), 
+        m_Stop(false) {
+        for (int index = 0; index < m_ThreadCount; ++index) {
+            m_Threads.push_back(std::thread(&WorkStealingPool::Work, this, index));
+        }
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Started.notify_all();
+        for (std::size_t i = 0; i < m_Threads.size(); ++i) m_Threads[i].join();
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator =(const WorkStealingPool&) = delete;
+
+    // 0 ~ taskCount - 1 의 작업을 func(task) 로 실행하고, 모두 끝나면 리턴합니다.
+    void Run(int taskCount, const std::function<void(int)>& func) {
+        // 쓰레드들이 모두 쉬고 있으므로 큐를 잠그지 않아도 됩니다. 
+        //  m_Mutex 를 잠그고 m_Generation 을 증가시키면 쓰레드들에게 보입니다.
+        for (int task = 0; task < taskCount; ++task) {
+            m_Queues[task % m_ThreadCount].m_Tasks.push_back(task); // 처음에는 골고루 나눠 줍니다.
+        }
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Func = &func;
+        m_Running = m_ThreadCount;
+        ++m_Generation;
+        m_Started.notify_all();
+        m_Finished.wait(lock, [this]() { return m_Running == 0; });
+        m_Func = nullptr;
+    }
+private:
+    void Work(int index) {
+        unsigned generation = 0;
+        for (;;) {
+            const std::function<void(int)>* func;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Started.wait(lock, [&]() { return m_Stop || m_Generation != generation; });
+                if (m_Stop) return;
+                generation = m_Generation;
+                func = m_Func;
+            }
+            int task;
+            while (Pop(m_Queues[index], task, false) || Steal(index, task)) {
+                (*func)(task);
+            }
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (--m_Running == 0) m_Finished.notify_one();
+        }
+    }
+    // 자신의 큐는 뒤에서, 훔칠때는 앞에서 가져와 서로 덜 부딪치게 합니다.
+    static bool Pop(Queue& queue, int& task, bool front) {
+        std::lock_guard<std::mutex> lock(queue.m_Mutex);
+        if (queue.m_Tasks.empty()) return false;
+        if (front) { task = queue.m_Tasks.front(); queue.m_Tasks.pop_front(); }
+        else { task = queue.m_Tasks.back(); queue.m_Tasks.pop_back(); }
+        return true;
+    }
+    bool Steal(int index, int& task) {
+        for (int i = 1; i < m_ThreadCount; ++i) {
+            if (Pop(m_Queues[(index + i) % m_ThreadCount], task, true)) return true;
+        }
+        return false; // 모든 큐가 비었습니다. Run() 중에는 작업이 추가되지 않으므로 이번 Run() 을 마쳐도 됩니다.
+    }
+};
+
+class TiledRenderer {
+    int m_TileSize;
+public:
+    explicit TiledRenderer(int tileSize) : m_TileSize(tileSize) {}
+
+    void Render(FrameBuffer& frameBuffer, const std::vector<Shape*>& shapes, WorkStealingPool& pool) const {
+        const int tilesX = (frameBuffer.GetWidth() + m_TileSize - 1) / m_TileSize;
+        const int tilesY = (frameBuffer.GetHeight() + m_TileSize - 1) / m_TileSize;
+
+        // #2. Binning. 원래 순서대로 추가하므로 타일 목록도 순서가 유지됩니다.
+        std::vector<std::vector<std::uint32_t> > bins(tilesX * tilesY);
+        for (std::size_t i = 0; i < shapes.size(); ++i) {
+            const Shape* shape = shapes[i];
+            if (shape->GetWidth() <= 0 || shape->GetHeight() <= 0) continue;
+            int tx0 = std::max(shape->GetLeft(), 0) / m_TileSize;
+            int ty0 = std::max(shape->GetTop(), 0) / m_TileSize;
+            int tx1 = std::min(shape->GetLeft() + shape->GetWidth() - 1, frameBuffer.GetWidth() - 1) / m_TileSize;
+            int ty1 = std::min(shape->GetTop() + shape->GetHeight() - 1, frameBuffer.GetHeight() - 1) / m_TileSize;
+            if (shape->GetLeft() + shape->GetWidth() <= 0 || shape->GetTop() + shape->GetHeight() <= 0) continue; // 화면 밖
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    bins[ty * tilesX + tx].push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+
+        // #3. 타일별로 병렬로 그립니다. 서로 다른 타일은 다른 픽셀을 씁니다.
+        pool.Run(tilesX * tilesY, [&](int tile) {
+            ClipRect clip;
+            clip.m_Left = (tile % tilesX) * m_TileSize;
+            clip.m_Top = (tile / tilesX) * m_TileSize;
+            clip.m_Right = std::min(clip.m_Left + m_TileSize, frameBuffer.GetWidth());
+            clip.m_Bottom = std::min(clip.m_Top + m_TileSize, frameBuffer.GetHeight());
+
+            const std::vector<std::uint32_t>& bin = bins[tile];
+            for (std::size_t i = 0; i < bin.size(); ++i) {
+                shapes[bin[i]]->Draw(frameBuffer, clip);
+            }
+        });
+    }
+};
+// (~) 주의. 큰 도형은 여러 타일에 들어가므로 타일마다 잘라내기 비용이 반복됩니다. 
+//  도형이 대부분 타일보다 크다면 타일 크기를 키우세요.
+
+/*      타일 렌더러 시험과 코어 수에 따른 확장성 측정      */
+// 겹치는 도형이 많은 장면을 단일 쓰레드로 그린 결과와 픽셀 단위로 같은지 확인하고, 
+//  쓰레드 수를 1 부터 hardware_concurrency 까지 늘려 가며 시간을 측정합니다.
+#include <chrono>
+#include <cstdlib>
+
+const int counts[] = { 100000, 1000000 };
+for (int count : counts) {
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < count; ++i) {
+        int l = std::rand() % 2000 - 40, t = std::rand() % 1160 - 40;
+        int w = 1 + std::rand() % 64, h = 1 + std::rand() % 64;
+        std::uint32_t color = static_cast<std::uint32_t>(std::rand()) | 0xFF000000;
+        if (i % 2 == 0) shapes.push_back(new Rectangle(l, t, w, h, color));
+        else shapes.push_back(new Ellipse(l, t, w, h, color));
+    }
+
+    FrameBuffer expected(1920, 1080);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < shapes.size(); ++i) shapes[i]->Draw(expected); // 단일 쓰레드, 원래 순서
+    double serialSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "count: " << count << " serial ms: " << serialSec * 1000 << std::endl;
+
+    TiledRenderer renderer(64);
+    const int maxThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1); // 알수 없으면 0 입니다.
+    // 1, 2, 4, ... 로 늘리되, 마지막에는 항상 maxThreads 를 측정합니다. (예: 12 코어면 1, 2, 4, 8, 12)
+    for (int threadCount = 1; threadCount <= maxThreads; 
+        threadCount = threadCount == maxThreads ? maxThreads + 1 : std::min(threadCount * 2, maxThreads)) {
+        WorkStealingPool pool(threadCount); // 쓰레드 생성은 측정에서 제외합니다.
+        FrameBuffer actual(1920, 1080);
+
+        begin = std::chrono::steady_clock::now();
+        renderer.Render(actual, shapes, pool);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        EXPECT_TRUE(actual == expected); // #3. 겹침 순서까지 단일 쓰레드와 같아야 합니다.
+        std::cout << "threads: " << threadCount << " ms: " << sec * 1000 
+            << " speedup: " << serialSec / sec << std::endl;
+    }
+    for (std::size_t i = 0; i < shapes.size(); ++i) delete shapes[i];
+}
+// Binning 은 단일 쓰레드로 하므로, 쓰레드를 늘려도 그 시간은 줄지 않습니다. (암달의 법칙)
+//  도형이 아주 많다면 Binning 도 도형 구간별로 나눠 병렬로 한 뒤 구간 순서대로 합칠수 있습니다.
+
+/*      DrawUtil::DrawAll - 타입별로 묶어 가상 함수 호출 없이 그리기      */
+/*
+DrawUtil::Draw(const IDrawable&) 를 도형마다 호출하면, 타입이 섞여 있을때 간접 호출 대상이 
+    매번 바뀌어 분기 예측이 실패하고, 컴파일러가 Draw() 를 인라인 할수 없습니다.
+
+    1. Rectangle, Ellipse, Triangle 은 더이상 상속하지 않으므로 final 로 선언합니다. 
+        final 클래스의 포인터로 Draw() 를 호출하면 컴파일러가 가상 함수 테이블을 거치지 않고 
+        직접 호출하며 (devirtualization), 인라인 할수 있습니다.
+    2. DrawBatch<Types...> 는 IDrawable* 들을 typeid 로 비교해 Types 별로 1번 묶습니다. 
+        Types 에 없는 타입은 마지막 묶음에 넣고 기존처럼 가상 함수로 그립니다.
+    3. Draw() 는 묶음마다 static_cast 한 final 타입 포인터로 루프를 돌며 그립니다. 
+        루프 안에서는 호출 대상이 바뀌지 않습니다.
+    4. DrawUtil::DrawAll() 은 IDrawable* 배열 (C++20 이라면 std::span) 을 받아 
+        DrawBatch<Rectangle, Ellipse, Triangle> 로 묶고 그립니다. 장면이 바뀌지 않고 여러번 
+        그린다면 DrawBatch 를 보관하여 묶는 비용을 1번만 치르세요.
+
+(~) 주의. 타입별로 묶으므로 그리는 순서가 바뀝니다. 겹치는 도형을 순서대로 칠해야 한다면 
+    (소프트웨어 래스터라이저) 사용할 수 없습니다.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+class IDrawable {
+private:
+    IDrawable(const IDrawable& other) = delete;
+    IDrawable& operator =(const IDrawable& other) = delete;
+protected:
+    IDrawable() {}
+    ~IDrawable() {}
+public:
+    virtual void Draw(DrawContext& context) const = 0;
+};
+
+class Shape : public IDrawable {
+protected:
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+public:
+    Shape(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    virtual ~Shape() {}
+};
+
+// #1. 더이상 상속하지 않으므로 final 입니다.
+class Rectangle final : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual void Draw(DrawContext& context) const override { DrawRectangle(context, m_Left, m_Top, m_Width, m_Height); }
+};
+class Ellipse final : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual void Draw(DrawContext& context) const override { DrawEllipse(context, m_Left, m_Top, m_Width, m_Height); }
+};
+class Triangle final : public Shape {
+public:
+    Triangle(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual void Draw(DrawContext& context) const override { DrawTriangle(context, m_Left, m_Top, m_Width, m_Height); }
+};
+
+// #2.
+template<typename... Types>
+class DrawBatch {
+    static constexpr std::size_t GroupCount = sizeof...(Types) + 1; // 마지막은 Types 에 없는 타입
+    std::vector<const IDrawable*> m_Groups[GroupCount];
+
+    // Types 에서 info 와 같은 타입의 위치 입니다. 없으면 sizeof...(Types) 입니다.
+    static std::size_t FindGroup(const std::type_info& info) {
+        std::size_t index = 0;
+        (void)((info == typeid(Types) ? false : (++index, true)) && ...);
+        return index;
+    }
+    // #3. U 는 final 이므로 p->Draw() 는 직접 호출되고 인라인 됩니다.
+    template<typename U>
+    static void DrawGroup(const std::vector<const IDrawable*>& group, DrawContext& context) {
+        static_assert(std::is_final<U>::value, "U must be final to devirtualize Draw()");
+        for (const IDrawable* drawable : group) {
+            static_cast<const U*>(drawable)->Draw(context);
+        }
+    }
+    template<std::size_t... Indexes>
+    void DrawGroups(DrawContext& context, std::index_sequence<Indexes...>) const {
+        (DrawGroup<Types>(m_Groups[Indexes], context), ...);
+    }
+public:
+    void Assign(IDrawable* const* drawables, std::size_t count) {
+        for (std::size_t i = 0; i < GroupCount; ++i) m_Groups[i].clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            m_Groups[FindGroup(typeid(*drawables[i]))].push_back(drawables[i]);
+        }
+    }
+    void Draw(DrawContext& context) const {
+        DrawGroups(context, std::index_sequence_for<Types...>());
+        for (const IDrawable* drawable : m_Groups[GroupCount - 1]) {
+            drawable->Draw(context); // Types 에 없는 타입은 가상 함수로 그립니다.
+        }
+    }
+};
+
+// #4.
+class DrawUtil {
+public:
+    static void Draw(const IDrawable& drawable, DrawContext& context) {
+        drawable.Draw(context);
+    }
+    static void DrawAll(IDrawable* const* drawables, std::size_t count, DrawContext& context) {
+        DrawBatch<Rectangle, Ellipse, Triangle> batch;
+        batch.Assign(drawables, count);
+        batch.Draw(context);
+    }
+};
+
+/*      DrawUtil::Draw 와 DrawAll 측정 - ns/shape, 분기 예측 실패      */
+// 타입이 무작위로 섞인 도형 10^6 개를 
+//  1. 도형마다 DrawUtil::Draw()
+//  2. DrawUtil::DrawAll() (묶는 비용 포함)
+//  3. 미리 묶어둔 DrawBatch::Draw()
+// 로 그리고, ns/shape 와 도형당 분기 예측 실패 수를 비교합니다.
+// 분기 예측 실패는 Linux 의 perf_event_open() 으로 셉니다. 권한이 없으면 (perf_event_paranoid) 
+//  n/a 를 출력합니다.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class BranchMissCounter {
+    int m_Fd;
+public:
+    BranchMissCounter() : m_Fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr = {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_Fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~BranchMissCounter() {
+#ifdef __linux__
+        if (m_Fd != -1) close(m_Fd);
+#endif
+    }
+    BranchMissCounter(const BranchMissCounter&) = delete;
+    BranchMissCounter& operator =(const BranchMissCounter&) = delete;
+
+    // func 을 실행하는 동안의 분기 예측 실패 수 입니다. 셀수 없으면 -1 입니다.
+    template<typename Func>
+    long long Measure(Func func) {
+#ifdef __linux__
+        if (m_Fd != -1) {
+            ioctl(m_Fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_Fd, PERF_EVENT_IOC_ENABLE, 0);
+            func();
+            ioctl(m_Fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long value = 0;
+            if (read(m_Fd, &value, sizeof(value)) == sizeof(value)) return value;
+            return -1;
+        }
+#endif
+        func();
+        return -1;
+    }
+};
+
+const int count = 1000000;
+std::vector<IDrawable*> drawables;
+std::vector<Shape*> shapes; // 소멸용
+for (int i = 0; i < count; ++i) {
+    int l = std::rand() % 1000, t = std::rand() % 1000, w = std::rand() % 100, h = std::rand() % 100;
+    Shape* shape = NULL;
+    switch (std::rand() % ShapeType_Count) {
+    case ShapeType_Rectangle: shape = new Rectangle(l, t, w, h); break;
+    case ShapeType_Ellipse: shape = new Ellipse(l, t, w, h); break;
+    default: shape = new Triangle(l, t, w, h); break;
+    }
+    shapes.push_back(shape);
+    drawables.push_back(shape);
+}
+
+BranchMissCounter counter;
+DrawContext c1, c2, c3;
+DrawBatch<Rectangle, Ellipse, Triangle> batch;
+batch.Assign(drawables.data(), drawables.size());
+
+std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+long long perObjectMisses = counter.Measure([&]() { for (IDrawable* drawable : drawables) DrawUtil::Draw(*drawable, c1); });
+double perObjectNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+begin = std::chrono::steady_clock::now();
+long long drawAllMisses = counter.Measure([&]() { DrawUtil::DrawAll(drawables.data(), drawables.size(), c2); });
+double drawAllNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+begin = std::chrono::steady_clock::now();
+long long batchMisses = counter.Measure([&]() { batch.Draw(c3); });
+double batchNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+EXPECT_TRUE(c1.m_Pixels == c2.m_Pixels && c2.m_Pixels == c3.m_Pixels);
+
+auto PerShape = [](long long misses) { return misses < 0 ? std::string("n/a") : std::to_string((double)misses / count); };
+std::cout << "Draw per object ns/shape: " << perObjectNs / count << " misses/shape: " << PerShape(perObjectMisses) << std::endl;
+std::cout << "DrawAll ns/shape: " << drawAllNs / count << " misses/shape: " << PerShape(drawAllMisses) << std::endl;
+std::cout << "DrawBatch ns/shape: " << batchNs / count << " misses/shape: " << PerShape(batchMisses) << std::endl;
+
+for (Shape* shape : shapes) delete shape;
+// 도형마다 그리면 3개 타입이 무작위로 섞여 있어 도형당 대략 0.6 회 간접 분기 예측이 실패합니다.
+//  DrawAll 은 묶을때 typeid 비교에서 같은 만큼 분기 예측이 실패하고 push_back 비용도 있어, 
+//  1번만 그릴때는 오히려 느릴수 있습니다. 묶어 둔 DrawBatch 를 여러번 그리면 분기 예측 실패가 
+//  거의 없어지고 Draw() 가 인라인 됩니다.
+
+/*      바이너리 그리기 명령 스트림 - 도형마다 std::endl 출력 대신      */
+/*
+Rectangle::Draw() 등은 std::cout << ... << std::endl 로 출력합니다. std::endl 은 매번 
+    flush 하므로 도형마다 write() 시스템 호출이 1번씩 일어납니다. 장면을 기록하고 다시 
+    재생하려면 텍스트 대신 작은 바이너리 명령을 모아서 한번에 씁니다.
+
+    1. DrawCommand 는 도형 1개를 그리는 고정 크기 (24 byte) 명령입니다. (타입, 좌표, 크기, 색상)
+    2. CommandBuffer 는 쓰레드마다 1개씩 있는 (thread_local) 명령 버퍼입니다. 
+        Draw() 는 잠금 없이 명령을 추가하기만 하고, Capacity 개가 모이면 Flush() 합니다. 
+        쓰레드가 종료될때도 소멸자에서 Flush() 합니다.
+    3. Flush() 는 BatchHeader 와 명령들을 writev() 1번으로 씁니다. 헤더를 명령 앞에 
+        복사하지 않아도 되고, 여러 쓰레드가 같은 파일에 써도 batch 단위로 섞이지 않습니다. 
+        (파일은 O_APPEND 로 여세요. 일부만 쓰여진 경우에는 나머지를 이어서 씁니다.)
+    4. CommandDecoder::Decode() 는 기록된 스트림을 batch 단위로 검증하며 명령마다 함수를 
+        호출합니다. WriteText() 로 기존 텍스트 출력을 만들거나, Rasterize() 로 래스터라이저에 
+        그릴수 있습니다.
+        래스터라이저의 Rectangle, Ellipse 는 이름이 겹치므로 RasterRectangle, RasterEllipse 라 
+        하겠습니다. 래스터라이저에 Triangle 은 없으므로 그리지 않습니다.
+
+(~) 주의. 스트림은 리틀 엔디안 (x86, ARM 기본) 그대로 기록합니다. 다른 엔디안에서는 
+    m_Magic 이 맞지 않아 Decode() 가 실패합니다.
+*/
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+#include <sys/uio.h>
+#include <unistd.h>
+
+enum CommandType : std::uint8_t {
+    CommandType_Rectangle,
+    CommandType_Ellipse,
+    CommandType_Triangle,
+    CommandType_Count
+};
+
+// #1.
+struct DrawCommand {
+    std::uint8_t m_Type;    // CommandType
+    std::uint8_t m_Reserved[3];
+    std::int32_t m_Left;
+    std::int32_t m_Top;
+    std::int32_t m_Width;
+    std::int32_t m_Height;
+    std::uint32_t m_Color;
+};
+static_assert(sizeof(DrawCommand) == 24, "DrawCommand layout is part of the stream format");
+static_assert(std::is_trivially_copyable<DrawCommand>::value, "DrawCommand is copied with memcpy");
+
+struct BatchHeader {
+    std::uint32_t m_Magic;          // Magic
+    std::uint16_t m_Version;        // Version
+    std::uint16_t m_CommandSize;    // sizeof(DrawCommand)
+    std::uint32_t m_ThreadId;       // 기록한 쓰레드
+    std::uint32_t m_Count;          // 뒤따르는 명령 수
+
+    static const std::uint32_t Magic = 0x444D4344; // "DCMD"
+    static const std::uint16_t Version = 1;
+};
+
+// #3. 모두 쓸때까지 writev() 를 반복합니다. iov 의 내용은 바뀝니다. 
+//  iovCount 는 IOV_MAX 보다 작아야 합니다. (SceneFile::Save() 도 사용합니다.)
+inline bool WriteAllV(int fd, iovec* iov, int iovCount) {
+    while (iovCount > 0) {
+        ssize_t written = writev(fd, iov, iovCount);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        std::size_t remain = static_cast<std::size_t>(written);
+        while (iovCount > 0 && remain >= iov->iov_len) { // 다 쓴 버퍼는 건너뜁니다.
+            remain -= iov->iov_len;
+            ++iov;
+            --iovCount;
+        }
+        if (iovCount > 0) { // 일부만 쓴 버퍼는 나머지부터 씁니다.
+            iov->iov_base = static_cast<char*>(iov->iov_base) + remain;
+            iov->iov_len -= remain;
+        }
+    }
+    return true;
+}
+
+// #2.
+class CommandBuffer {
+    static const std::size_t Capacity = 4096; // batch 1개의 최대 명령 수 (96KB)
+
+    std::vector<DrawCommand> m_Commands;
+    std::uint32_t m_ThreadId;
+
+    CommandBuffer() : m_ThreadId(NextThreadId()) { m_Commands.reserve(Capacity); }
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator =(const CommandBuffer&) = delete;
+
+    static std::uint32_t NextThreadId() {
+        static std::atomic<std::uint32_t> s_Next(0);
+        return s_Next++;
+    }
+public:
+    ~CommandBuffer() { Flush(); }
+
+    // 모든 쓰레드의 버퍼가 Flush() 할 파일입니다. -1 이면 버립니다.
+    static std::atomic<int>& GetOutput() {
+        static std::atomic<int> s_Fd(-1);
+        return s_Fd;
+    }
+    static CommandBuffer& GetThread() {
+        thread_local CommandBuffer s_Buffer;
+        return s_Buffer;
+    }
+
+    void Append(CommandType type, int l, int t, int w, int h, std::uint32_t color) {
+        DrawCommand command = { type, { 0, 0, 0 }, l, t, w, h, color };
+        m_Commands.push_back(command);
+        if (m_Commands.size() == Capacity) Flush();
+    }
+    // #3. 쓰기에 실패하면 false 입니다. 실패해도 버퍼는 비웁니다.
+    bool Flush() {
+        if (m_Commands.empty()) return true;
+
+        BatchHeader header = { BatchHeader::Magic, BatchHeader::Version, sizeof(DrawCommand), 
+            m_ThreadId, static_cast<std::uint32_t>(m_Commands.size()) };
+        iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = m_Commands.data();
+        iov[1].iov_len = m_Commands.size() * sizeof(DrawCommand);
+
+        const int fd = GetOutput();
+        bool result = fd != -1 && WriteAllV(fd, iov, 2);
+        m_Commands.clear();
+        return result;
+    }
+};
+
+// 도형들은 Draw() 에서 출력하지 않고 명령을 추가합니다.
+class Shape {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+    std::uint32_t m_Color;
+private:
+    Shape(const Shape& other) = delete;
+    Shape& operator =(const Shape& other) = delete;
+protected:
+    Shape(int l, int t, int w, int h, std::uint32_t color) :
+        m_Left(l), m_Top(t), m_Width(w), m_Height(h), m_Color(color) {}
+    void Record(CommandType type) const {
+        CommandBuffer::GetThread().Append(type, m_Left, m_Top, m_Width, m_Height, m_Color);
+    }
+public:
+    virtual ~Shape() {}
+    virtual void Draw() const = 0;
+};
+
+class Rectangle : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+    virtual void Draw() const { Record(CommandType_Rectangle); }
+};
+class Ellipse : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+    virtual void Draw() const { Record(CommandType_Ellipse); }
+};
+class Triangle : public Shape {
+public:
+    Triangle(int l, int t, int w, int h, std::uint32_t color) : Shape(l, t, w, h, color) {}
+    virtual void Draw() const { Record(CommandType_Triangle); }
+};
+
+// #4.
+class CommandDecoder {
+public:
+    // data 의 batch 들을 순서대로 해석해 명령마다 func(const DrawCommand&) 을 호출합니다. 
+    //  형식이 잘못되었거나 잘린 batch 가 있으면 false 입니다.
+    template<typename Func>
+    static bool Decode(const char* data, std::size_t size, Func func) {
+        while (size > 0) {
+            BatchHeader header;
+            if (size < sizeof(header)) return false;
+            std::memcpy(&header, data, sizeof(header));
+            if (header.m_Magic != BatchHeader::Magic || header.m_Version != BatchHeader::Version ||
+                header.m_CommandSize != sizeof(DrawCommand)) return false;
+            data += sizeof(header);
+            size -= sizeof(header);
+
+            const std::size_t bytes = static_cast<std::size_t>(header.m_Count) * sizeof(DrawCommand);
+            if (size < bytes) return false;
+            for (std::uint32_t i = 0; i < header.m_Count; ++i) {
+                DrawCommand command;
+                std::memcpy(&command, data + i * sizeof(DrawCommand), sizeof(command)); // 정렬되지 않았을수 있습니다.
+                if (command.m_Type >= CommandType_Count) return false;
+                func(command);
+            }
+            data += bytes;
+            size -= bytes;
+        }
+        return true;
+    }
+    // 기존 Draw() 와 같은 텍스트 입니다. 줄바꿈은 하지 않습니다.
+    static void WriteText(std::ostream& os, const DrawCommand& command) {
+        static const char* const names[CommandType_Count] = { "Rectangle", "Ellipse", "Triangle" };
+        os << names[command.m_Type] << "::Draw() " << command.m_Left << ' ' << command.m_Top << ' ' 
+            << command.m_Width << ' ' << command.m_Height << ' ' << command.m_Color;
+    }
+    static void Rasterize(FrameBuffer& frameBuffer, const DrawCommand& command) {
+        switch (command.m_Type) {
+        case CommandType_Rectangle: 
+            RasterRectangle(command.m_Left, command.m_Top, command.m_Width, command.m_Height, command.m_Color).Draw(frameBuffer); 
+            break;
+        case CommandType_Ellipse: 
+            RasterEllipse(command.m_Left, command.m_Top, command.m_Width, command.m_Height, command.m_Color).Draw(frameBuffer); 
+            break;
+        default: // 래스터라이저에 Triangle 은 없습니다.
+            break;
+        }
+    }
+};
+
+/*      명령 스트림 측정 - 도형마다 flush 와 비교      */
+// 도형 10^5 개를
+//  1. 도형마다 텍스트 + std::endl (flush) 로 파일에 출력
+//  2. Draw() 로 명령 버퍼에 추가하고 batch 마다 writev()
+// 하여 shapes/s 를 비교합니다. 기록한 스트림을 다시 읽어 텍스트로 바꾼 결과가 1번의 
+//  출력과 같은지, 래스터라이저로 그린 결과가 도형을 직접 그린 결과와 같은지도 확인합니다.
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+std::vector<char> ReadFile(const char* path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+const int count = 100000;
+std::vector<Shape*> shapes;
+std::vector<DrawCommand> expected; // 만든 도형과 같은 명령
+for (int i = 0; i < count; ++i) {
+    DrawCommand c = { static_cast<std::uint8_t>(std::rand() % CommandType_Count), { 0, 0, 0 },
+        std::rand() % 1920, std::rand() % 1080, 1 + std::rand() % 64, 1 + std::rand() % 64, 
+        static_cast<std::uint32_t>(std::rand()) | 0xFF000000 };
+    expected.push_back(c);
+    switch (c.m_Type) {
+    case CommandType_Rectangle: shapes.push_back(new Rectangle(c.m_Left, c.m_Top, c.m_Width, c.m_Height, c.m_Color)); break;
+    case CommandType_Ellipse: shapes.push_back(new Ellipse(c.m_Left, c.m_Top, c.m_Width, c.m_Height, c.m_Color)); break;
+    default: shapes.push_back(new Triangle(c.m_Left, c.m_Top, c.m_Width, c.m_Height, c.m_Color)); break;
+    }
+}
+
+// 1. 도형마다 flush 합니다.
+std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+{
+    std::ofstream text("draw_text.log");
+    for (const DrawCommand& c : expected) {
+        CommandDecoder::WriteText(text, c);
+        text << std::endl;
+    }
+}
+double textSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+// 2. batch 마다 writev() 합니다.
+int fd = open("draw_commands.bin", O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+CommandBuffer::GetOutput() = fd;
+begin = std::chrono::steady_clock::now();
+for (Shape* shape : shapes) shape->Draw();
+EXPECT_TRUE(CommandBuffer::GetThread().Flush());
+double binarySec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+std::cout << "flush per shape shapes/s: " << count / textSec 
+    << " command stream shapes/s: " << count / binarySec << std::endl;
+
+// 기록한 스트림을 텍스트로 바꾸면 1번의 출력과 같습니다.
+std::vector<char> stream = ReadFile("draw_commands.bin");
+std::ostringstream decoded;
+EXPECT_TRUE(CommandDecoder::Decode(stream.data(), stream.size(), [&](const DrawCommand& c) {
+    CommandDecoder::WriteText(decoded, c);
+    decoded << '\n';
+}));
+std::vector<char> text = ReadFile("draw_text.log");
+EXPECT_TRUE(decoded.str() == std::string(text.begin(), text.end()));
+
+// 기록한 스트림을 래스터라이저로 그리면 도형을 직접 그린 결과와 같습니다.
+FrameBuffer replayed(1920, 1080), direct(1920, 1080);
+EXPECT_TRUE(CommandDecoder::Decode(stream.data(), stream.size(), [&](const DrawCommand& c) {
+    CommandDecoder::Rasterize(replayed, c);
+}));
+for (const DrawCommand& c : expected) CommandDecoder::Rasterize(direct, c);
+EXPECT_TRUE(replayed == direct);
+
+// 잘린 스트림은 실패합니다.
+EXPECT_TRUE(!CommandDecoder::Decode(stream.data(), stream.size() - 1, [](const DrawCommand&) {}));
+
+// 여러 쓰레드가 같은 파일에 기록해도 batch 단위로 섞이므로 모두 해석할수 있습니다.
+//  (쓰레드가 종료될때 thread_local 버퍼가 Flush() 합니다.)
+ftruncate(fd, 0);
+std::vector<std::thread> threads;
+for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([&shapes]() { for (Shape* shape : shapes) shape->Draw(); }));
+}
+for (std::thread& thread : threads) thread.join();
+stream = ReadFile("draw_commands.bin");
+std::size_t decodedCount = 0;
+EXPECT_TRUE(CommandDecoder::Decode(stream.data(), stream.size(), [&](const DrawCommand&) { ++decodedCount; }));
+EXPECT_TRUE(decodedCount == 4 * shapes.size());
+
+CommandBuffer::GetOutput() = -1;
+close(fd);
+for (Shape* shape : shapes) delete shape;
+// 도형마다 flush 하면 도형마다 시스템 호출을 1번 하지만, 명령 스트림은 4096 개마다 1번 
+//  하고 텍스트 변환도 하지 않습니다. 텍스트가 필요하면 나중에 Decode() 로 만듭니다.
+
+/*      메모리 맵 장면 파일 - 복사 없이 불러오기      */
+/*
+도형 수백만개를 파일에서 읽어 도형마다 new 로 다시 만들면, 할당과 파싱이 시작 시간의 
+    대부분을 차지합니다. ShapeStore 처럼 타입별 열 (column) 로 저장하면, 파일 내용을 그대로 
+    메모리에 매핑해서 사용할수 있습니다.
+
+    1. 파일은 SceneHeader 와 타입별 4개의 열 (m_Left, m_Top, m_Width, m_Height) 로 구성됩니다.
+        모든 열은 파일 시작에서 Alignment (64 byte, 캐시 라인) 배수 위치에 있으므로, 매핑한 
+        주소에서 바로 int 배열로 읽을수 있습니다. (mmap 은 페이지 단위로 정렬된 주소를 줍니다.)
+    2. m_Magic 과 m_Version 으로 형식을 확인합니다. 형식을 바꾸면 Version 을 올리세요.
+    3. SceneFile::Save() 는 헤더, 채움 (padding), 열들을 writev() 로 한번에 순서대로 씁니다. 
+        열들을 버퍼 1개로 모으는 복사도 하지 않습니다.
+    4. MappedScene::Open() 은 파일을 읽기 전용으로 mmap() 하고 헤더만 검증합니다. 
+        도형마다 할당하거나 파싱하지 않고, GetColumns() 는 매핑된 메모리를 가리키는 
+        ColumnView 를 돌려줍니다. 실제 디스크 읽기는 처음 접근한 페이지부터 운영체제가 
+        합니다.
+    5. MappedScene 은 소멸자에서 munmap() 합니다. 복사할수 없고, ColumnView 는 MappedScene 
+        보다 오래 사용할수 없습니다.
+
+(~) 주의. 열은 리틀 엔디안 int (4 byte) 그대로 저장합니다. 다른 엔디안에서는 m_Magic 이 맞지 않아 
+    Open() 이 실패합니다.
+*/
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static_assert(sizeof(int) == 4, "columns are stored as 32bit int");
+
+// #1.
+struct SceneHeader {
+    static const std::uint32_t Magic = 0x314E4353; // "SCN1"
+    static const std::uint16_t Version = 1;
+    static const std::size_t Alignment = 64;
+    enum { Column_Left, Column_Top, Column_Width, Column_Height, Column_Count };
+
+    std::uint32_t m_Magic;
+    std::uint16_t m_Version;
+    std::uint16_t m_HeaderSize;     // sizeof(SceneHeader)
+    std::uint64_t m_FileSize;
+    struct TypeInfo {
+        std::uint64_t m_Count;
+        std::uint64_t m_Offsets[Column_Count]; // 파일 시작에서 열의 위치
+    } m_Types[ShapeType_Count];
+
+    static std::uint64_t AlignUp(std::uint64_t value) { return (value + Alignment - 1) / Alignment * Alignment; }
+};
+
+// #3.
+class SceneFile {
+public:
+    // store 를 path 에 저장합니다. 실패하면 false 입니다.
+    static bool Save(const ShapeStore& store, const char* path) {
+        static const char padding[SceneHeader::Alignment] = {};
+
+        SceneHeader header;
+        std::memset(&header, 0, sizeof(header)); // 사용하지 않는 바이트도 0 으로 저장합니다.
+        header.m_Magic = SceneHeader::Magic;
+        header.m_Version = SceneHeader::Version;
+        header.m_HeaderSize = sizeof(SceneHeader);
+
+        std::vector<iovec> iov;
+        iov.push_back(MakeIovec(&header, sizeof(header)));
+        std::uint64_t offset = sizeof(header);
+        for (int type = 0; type < ShapeType_Count; ++type) {
+            const ShapeStore::Columns& c = store.GetColumns(static_cast<ShapeType>(type));
+            const std::vector<int>* columns[SceneHeader::Column_Count] = { &c.m_Left, &c.m_Top, &c.m_Width, &c.m_Height };
+            header.m_Types[type].m_Count = c.GetSize();
+            for (int column = 0; column < SceneHeader::Column_Count; ++column) {
+                std::uint64_t aligned = SceneHeader::AlignUp(offset);
+                if (aligned != offset) iov.push_back(MakeIovec(const_cast<char*>(padding), aligned - offset));
+                header.m_Types[type].m_Offsets[column] = aligned;
+                std::size_t bytes = columns[column]->size() * sizeof(int);
+                if (bytes != 0) iov.push_back(MakeIovec(const_cast<int*>(columns[column]->data()), bytes));
+                offset = aligned + bytes;
+            }
+        }
+        header.m_FileSize = offset;
+
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) return false;
+        bool result = WriteAllV(fd, iov.data(), static_cast<int>(iov.size())); // 명령 버퍼 Flush() 와 같은 함수 입니다.
+        return close(fd) == 0 && result;
+    }
+private:
+    static iovec MakeIovec(void* base, std::size_t len) {
+        iovec result;
+        result.iov_base = base;
+        result.iov_len = len;
+        return result;
+    }
+};
+
+// #4.
+class MappedScene {
+public:
+    // 매핑된 한 타입의 열들 입니다.
+    struct ColumnView {
+        const int* m_Left;
+        const int* m_Top;
+        const int* m_Width;
+        const int* m_Height;
+        std::size_t m_Count;
+    };
+private:
+    const char* m_Data;
+    std::size_t m_Size;
+    ColumnView m_Views[ShapeType_Count];
+
+    MappedScene(const MappedScene&) = delete;
+    MappedScene& operator =(const MappedScene&) = delete;
+
+    // #2. 헤더와 열 위치가 파일 안에 있고 정렬되었는지 검증합니다.
+    bool Validate() {
+        if (m_Size < sizeof(SceneHeader)) return false;
+        SceneHeader header;
+        std::memcpy(&header, m_Data, sizeof(header));
+        if (header.m_Magic != SceneHeader::Magic || header.m_Version != SceneHeader::Version ||
+            header.m_HeaderSize != sizeof(SceneHeader) || header.m_FileSize != m_Size) return false;
+
+        for (int type = 0; type < ShapeType_Count; ++type) {
+            const SceneHeader::TypeInfo& info = header.m_Types[type];
+            if (info.m_Count > m_Size / sizeof(int)) return false;
+            const int* columns[SceneHeader::Column_Count];
+            for (int column = 0; column < SceneHeader::Column_Count; ++column) {
+                std::uint64_t offset = info.m_Offsets[column];
+                if (offset % SceneHeader::Alignment != 0 || offset > m_Size || 
+                    info.m_Count * sizeof(int) > m_Size - offset) return false;
+                columns[column] = reinterpret_cast<const int*>(m_Data + offset);
+            }
+            ColumnView view = { columns[0], columns[1], columns[2], columns[3], static_cast<std::size_t>(info.m_Count) };
+            m_Views[type] = view;
+        }
+        return true;
+    }
+    template<typename DrawFunc>
+    static void DrawColumns(DrawContext& context, const ColumnView& c, DrawFunc drawFunc) {
+        for (std::size_t i = 0; i < c.m_Count; ++i) {
+            drawFunc(context, c.m_Left[i], c.m_Top[i], c.m_Width[i], c.m_Height[i]);
+        }
+    }
+public:
+    MappedScene() : m_Data(NULL), m_Size(0), m_Views() {}
+    ~MappedScene() { Close(); } // #5
+
+    // path 를 매핑합니다. 파일이 없거나 형식이 잘못되었으면 false 입니다.
+    bool Open(const char* path) {
+        Close();
+        int fd = open(path, O_RDONLY);
+        if (fd == -1) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* data = mmap(NULL, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // 매핑은 fd 를 닫아도 유지됩니다.
+        if (data == MAP_FAILED) return false;
+
+        m_Data = static_cast<const char*>(data);
+        m_Size = static_cast<std::size_t>(st.st_size);
+        if (!Validate()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+    void Close() {
+        if (m_Data != NULL) munmap(const_cast<char*>(m_Data), m_Size);
+        m_Data = NULL;
+        m_Size = 0;
+        std::memset(m_Views, 0, sizeof(m_Views));
+    }
+    const ColumnView& GetColumns(ShapeType type) const { return m_Views[type]; }
+
+    // ShapeStore::DrawAll() 과 같이 타입별로 그립니다.
+    void DrawAll(DrawContext& context) const {
+        DrawColumns(context, m_Views[ShapeType_Rectangle], &DrawRectangle);
+        DrawColumns(context, m_Views[ShapeType_Ellipse], &DrawEllipse);
+        DrawColumns(context, m_Views[ShapeType_Triangle], &DrawTriangle);
+    }
+};
+
+/*      장면 파일 불러오기 측정 - cold, warm      */
+// 도형 10^7 개를 저장한 뒤, 
+//  1. 파일을 read() 로 읽어 도형마다 new 로 만드는 기존 방식
+//  2. MappedScene::Open() 후 DrawAll() (매핑된 페이지를 모두 읽습니다.)
+// 의 시간을 비교합니다. cold 는 posix_fadvise(POSIX_FADV_DONTNEED) 로 파일의 페이지 캐시를 
+//  비운 뒤 측정하고, warm 은 페이지 캐시에 있는 상태에서 측정합니다. 
+//  (POSIX_FADV_DONTNEED 는 권한 없이 사용할수 있지만, 캐시를 반드시 비운다는 보장은 없습니다. 
+//  정확한 cold 측정은 root 로 /proc/sys/vm/drop_caches 를 사용하세요.)
+#include <chrono>
+#include <cstdlib>
+
+void DropPageCache(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// 기존 방식 : 파일 전체를 읽고 도형마다 new 합니다.
+std::int64_t LoadWithNew(const char* path, std::vector<Shape*>& shapes) {
+    std::vector<char> data;
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    fstat(fd, &st);
+    data.resize(static_cast<std::size_t>(st.st_size));
+    for (std::size_t done = 0; done < data.size(); ) {
+        ssize_t n = read(fd, data.data() + done, data.size() - done);
+        if (n <= 0) break;
+        done += static_cast<std::size_t>(n);
+    }
+    close(fd);
+
+    SceneHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    for (int type = 0; type < ShapeType_Count; ++type) {
+        const SceneHeader::TypeInfo& info = header.m_Types[type];
+        for (std::uint64_t i = 0; i < info.m_Count; ++i) {
+            int values[SceneHeader::Column_Count];
+            for (int column = 0; column < SceneHeader::Column_Count; ++column) {
+                std::memcpy(&values[column], data.data() + info.m_Offsets[column] + i * sizeof(int), sizeof(int));
+            }
+            switch (type) {
+            case ShapeType_Rectangle: shapes.push_back(new Rectangle(values[0], values[1], values[2], values[3])); break;
+            case ShapeType_Ellipse: shapes.push_back(new Ellipse(values[0], values[1], values[2], values[3])); break;
+            default: shapes.push_back(new Triangle(values[0], values[1], values[2], values[3])); break;
+            }
+        }
+    }
+    DrawContext context;
+    for (Shape* shape : shapes) shape->Draw(context);
+    return context.m_Pixels;
+}
+
+const char* path = "scene.bin";
+const int count = 10000000;
+ShapeStore store;
+for (int i = 0; i < count; ++i) {
+    store.Add(static_cast<ShapeType>(std::rand() % ShapeType_Count), 
+        std::rand() % 1000, std::rand() % 1000, std::rand() % 100, std::rand() % 100);
+}
+DrawContext expected;
+store.DrawAll(expected);
+
+std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+EXPECT_TRUE(SceneFile::Save(store, path));
+std::cout << "save ms: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() << std::endl;
+
+const char* names[] = { "cold", "warm" };
+for (int pass = 0; pass < 2; ++pass) {
+    // 1. 도형마다 new
+    if (pass == 0) DropPageCache(path);
+    std::vector<Shape*> shapes;
+    begin = std::chrono::steady_clock::now();
+    EXPECT_TRUE(LoadWithNew(path, shapes) == expected.m_Pixels);
+    double newMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    for (Shape* shape : shapes) delete shape;
+
+    // 2. mmap
+    if (pass == 0) DropPageCache(path);
+    begin = std::chrono::steady_clock::now();
+    MappedScene scene;
+    EXPECT_TRUE(scene.Open(path));
+    double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    DrawContext context;
+    scene.DrawAll(context);
+    double mappedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    EXPECT_TRUE(context.m_Pixels == expected.m_Pixels);
+
+    std::cout << names[pass] << " load ms - new per shape: " << newMs 
+        << " mmap open: " << openMs << " mmap open + DrawAll: " << mappedMs << std::endl;
+}
+
+// 형식이 잘못된 파일은 Open() 이 실패합니다.
+{
+    int fd = open(path, O_WRONLY);
+    EXPECT_TRUE(ftruncate(fd, sizeof(SceneHeader) + 1) == 0); // 잘린 파일
+    close(fd);
+    MappedScene scene;
+    EXPECT_TRUE(!scene.Open(path));
+}
+unlink(path);
+// mmap 은 Open() 자체가 파일 크기와 무관하게 거의 0 이고, 할당이 없으므로 warm 에서는 
+//  DrawAll() 의 순차 읽기 시간만 남습니다. cold 에서는 디스크 읽기가 대부분이지만 
+//  순차 접근이어서 운영체제가 미리 읽기 (readahead) 를 합니다. 
+//  미리 모두 읽히게 하려면 mmap() 에 MAP_POPULATE 를 사용할수 있습니다.
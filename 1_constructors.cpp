@@ -145,6 +145,8 @@ public:
 코드도 간결하고 분석하기 좋습니다.
 복사 대입 연산까지 지원하는 것은 복사 대입 연산자까지 지원하는 스마트 포인터를 참고하세요.
 그리고, 모든 타입을 지원하는 일반화된 스마트 포인터의 구현 예는 auto_ptr을 참고하세요.
+깊은 복제를 하는 일반화된 스마트 포인터의 구현 예는 ClonePtr을 참고하세요.
+(ClonePtr<int> 가 아래 IntPtr 을 대체합니다. 아래 IntPtr 은 원리 설명을 위해 그대로 둡니다.)
 
 1. 스마트 포인터를 클래스 멤버 변수로 정의해 둡니다.
 2. 암시적 복사 생성자가 호출되면, 내부적으로 멤버 변수들의 복사 생성자를 호출합니다.
@@ -121,6 +121,7 @@ swap(T& left, T& right) {
 /*
 1. Big은 임의의 큰 데이터를 처리하는 클래스로 가정합니다.
 2. Big의 복사 생성자와 복사 대입 연산자에 메시지를 출력해서 복사 부하를 확인합니다.
+    (출력 비용이 크므로 실제 프로그램에서는 복사 트래픽 카운터를 참고하세요.)
 3. T는 Big 을 포인터 멤버 변수로 관리합니다.
 4. 포인터 멤버 변수의 소유권 분쟁이 없도록 T의 복사 생성자에서 Big을 복제하고 소멸자에서
     delete 합니다.
@@ -204,6 +205,8 @@ EXPECT_TRUE(t2.GetBig()->GetVal() == 10);
 // 암시적 복사 생성자, 암시적 소명자, 암시적 복사 대입 연산자와 호완되어
 //  별도로 구현할 필요가 없어집니다. 따라서 다음처럼 복사 생성자, 소멸자, 복사 대입
 //  연산자 정의 없이 간소하게 클래스를 작성할수 있습니다.
+// 이동 연산과 Small Buffer Optimization 까지 지원하는 일반화된 구현은 ClonePtr 을 참고하세요.
+//  (ClonePtr<int> 가 이 IntPtr 을 대체합니다.)
 class T {
     IntPtr m_Val;
 public:
@@ -329,3 +332,1435 @@ public:
 }
 // 혹은 멤버 변수를 무조건 1개로 유지하는 방법도 있습니다. (Plmpl 이디엄 참조)
 
+
+/*  Copy-on-Write 스마트 포인터 - 수정할 때만 복제하기  */
+/*
+IntPtr은 복사 생성/복사 대입시 매번 new int(*other.m_Ptr)로 깊은 복제를 합니다.
+    따라서 IntPtr 멤버 변수가 2개인 T를 복사하면 힙 할당이 2회 발생합니다.
+복사한 개체를 주로 읽기만 하고 수정은 드물게 한다면, 복제를 수정 시점까지 미룰수 
+    있습니다. 이를 Copy-on-Write (COW) 라고 합니다.
+
+1. 힙 개체와 참조 카운트를 Block 으로 묶어, 복사본들이 같은 Block 을 공유합니다.
+2. 복사 생성/복사 대입시에는 참조 카운트만 증가시킵니다. (힙 할당 없음)
+3. 상수 operator *, operator -> 는 공유중인 Block 을 그대로 읽습니다.
+4. 비상수 operator *, operator -> 를 호출하면 수정할 수도 있으므로, 공유중일 때만
+    Block 을 복제하여 혼자 소유하게 합니다. (Detach)
+5. 여러 쓰레드에서 복사본을 각자 사용할수 있도록 참조 카운트는 std::atomic 으로 관리합니다.
+    (C++11~)
+6. 마지막 참조가 사라질때 Block 과 힙 개체를 delete 합니다.
+*/
+#include <atomic>
+#include <memory>
+
+// 복사 생성/복사 대입시 참조 카운트만 증가시키고, 비상수 접근시에만 복제합니다.
+class CowIntPtr {
+private:
+    struct Block { // #1
+        std::atomic<int> m_RefCount;
+        int* m_Ptr; // new로 생성된 개체입니다.
+        explicit Block(int* ptr) : 
+            m_RefCount(1), 
+            m_Ptr(ptr) {}
+        ~Block() { delete m_Ptr; }
+    private:
+        Block(const Block& other) {}    // 복사하지 않습니다.
+        Block& operator =(const Block& other) { return *this; }
+    };
+    Block* m_Block;
+
+    // Block 할당에 실패하면 ptr 을 delete 합니다. ptr 의 소유권은 항상 넘겨 받습니다.
+    static Block* CreateBlock(int* ptr) {
+        std::unique_ptr<int> owner(ptr);
+        Block* block = new Block(ptr);
+        owner.release(); // 이제 Block 이 소유합니다.
+        return block;
+    }
+public:
+    explicit CowIntPtr(int* ptr) :
+        m_Block(ptr != NULL ? CreateBlock(ptr) : NULL) {}
+
+    // (0) #2. 복제하지 않고 참조 카운트만 증가시킵니다.
+    CowIntPtr(const CowIntPtr& other) :
+        m_Block(other.m_Block) {
+        if (m_Block != NULL) {
+            // 증가시에는 다른 메모리와의 순서 보장이 필요 없습니다.
+            m_Block->m_RefCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    ~CowIntPtr() { Release(); } // #6
+
+    // swap 을 이용하므로 예외에 안전합니다. 참조 카운트만 변경되므로 힙 할당도 없습니다.
+    CowIntPtr& operator =(const CowIntPtr& other) {
+        CowIntPtr temp(other);
+        Swap(temp);
+        return *this;
+    }
+    void Swap(CowIntPtr& other) {
+        std::swap(this->m_Block, other.m_Block);
+    }
+
+    // #3. 상수 접근은 공유중인 Block 을 그대로 읽습니다.
+    const int* operator ->() const { return m_Block->m_Ptr; }
+    const int& operator *() const { return *m_Block->m_Ptr; }
+
+    // #4. 비상수 접근은 수정할 수도 있으므로 혼자 소유한 뒤 접근합니다.
+    int* operator ->() { Detach(); return m_Block->m_Ptr; }
+    int& operator *() { Detach(); return *m_Block->m_Ptr; }
+
+    bool IsValid() const { return m_Block != NULL ? true : false; }
+    bool IsShared() const { 
+        return m_Block != NULL && m_Block->m_RefCount.load(std::memory_order_acquire) > 1; 
+    }
+private:
+    void Detach() {
+        if (!IsShared()) return; // 혼자 소유하고 있다면 복제할 필요가 없습니다.
+
+        // (0) 복제가 끝난 뒤에 교체하므로, new 에서 예외가 발생해도 this는 그대로 입니다.
+        //  Block 할당이 실패해도 CreateBlock() 이 복제한 int 를 delete 하므로 누수가 없습니다.
+        Block* block = CreateBlock(new int(*m_Block->m_Ptr));
+        Release();
+        m_Block = block;
+    }
+    void Release() {
+        // 마지막 참조라면 다른 쓰레드에서의 수정 내용이 모두 보이도록 acq_rel 로 감소시킵니다.
+        if (m_Block != NULL && m_Block->m_RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete m_Block;
+        }
+        m_Block = NULL;
+    }
+};
+
+class T {
+    // (0) IntPtr 대신 CowIntPtr 을 사용하면, 암시적 복사 생성자에서 힙 할당이 없습니다.
+    CowIntPtr m_Val1;
+    CowIntPtr m_Val2;
+public:
+    // val1, val2 : new 로 생성된 것을 전달하세요.
+    T(int* val1, int* val2) :
+        m_Val1(val1),
+        m_Val2(val2) {}
+    T& operator =(const T& other) {
+        T temp(other);  // (0) 참조 카운트만 증가합니다.
+        Swap(temp);
+        return *this;
+    }
+    void Swap(T& other) {
+        m_Val1.Swap(other.m_Val1);
+        m_Val2.Swap(other.m_Val2);
+    }
+
+    int GetVal1() const { return *m_Val1; } // 상수 접근이라 복제하지 않습니다.
+    int GetVal2() const { return *m_Val2; }
+    void SetVal1(int val) { *m_Val1 = val; } // 비상수 접근이라 공유중이면 복제합니다.
+    void SetVal2(int val) { *m_Val2 = val; }
+};
+
+{
+    T t1(new int(10), new int(20));
+    T t2(t1);   // (0) 힙 할당 없이 t1과 Block을 공유합니다.
+
+    EXPECT_TRUE(t2.GetVal1() == 10 && t2.GetVal2() == 20);
+
+    t2.SetVal1(1);  // (0) 이때 m_Val1만 복제됩니다. m_Val2는 여전히 공유합니다.
+
+    EXPECT_TRUE(t1.GetVal1() == 10 && t2.GetVal1() == 1);   // t1은 영향을 받지 않습니다.
+    EXPECT_TRUE(t1.GetVal2() == 20 && t2.GetVal2() == 20);
+}
+// (~) 주의. 비상수 개체에서 *ptr 을 호출하면 읽기만 하더라도 복제됩니다. 
+//  읽기 전용이라면 GetVal1() 처럼 상수 멤버 함수에서 접근하세요.
+// (~) 주의. 참조 카운트는 쓰레드에 안전하지만, 같은 CowIntPtr 개체를 여러 쓰레드에서 
+//  동시에 수정하는 것까지 안전하지는 않습니다. 쓰레드마다 자신의 복사본을 사용하세요.
+
+/*  깊은 복제와 Copy-on-Write 측정    */
+// 전역 operator new 를 재정의하여 힙 할당 횟수를 세고, std::chrono로 시간을 측정합니다.
+//  (측정용 코드입니다. 실제 제품 코드에서는 전역 operator new를 재정의하지 마세요.)
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> g_AllocCount(0);   // 힙 할당 횟수
+static std::atomic<long long> g_AllocBytes(0);   // 힙 할당 바이트
+
+void* operator new(std::size_t size) {
+    g_AllocCount.fetch_add(1, std::memory_order_relaxed);
+    g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+
+// Func 를 count 회 실행하고 1회당 시간(ns)과 힙 할당 횟수를 출력합니다.
+template<typename Func>
+void Measure(const char* name, int count, Func func) {
+    long long allocBefore = g_AllocCount.load();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        func(i);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long allocs = g_AllocCount.load() - allocBefore;
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    std::cout << name 
+        << " ns/op: " << ns / count 
+        << " allocs/op: " << static_cast<double>(allocs) / count << std::endl;
+}
+
+// DeepT 는 IntPtr 을 사용하는 T, CowT 는 CowIntPtr 을 사용하는 T 입니다.
+const int count = 1000000;
+DeepT deepSrc(new int(10), new int(20));
+CowT cowSrc(new int(10), new int(20));
+int sum = 0;   // 최적화로 루프가 제거되지 않도록 결과를 사용합니다.
+
+Measure("DeepT copy", count, [&](int) { DeepT t(deepSrc); sum += t.GetVal1(); });    // 복사 1회당 2회 할당
+Measure("CowT copy", count, [&](int) { CowT t(cowSrc); sum += t.GetVal1(); });       // 복사 1회당 0회 할당
+Measure("DeepT copy+write", count, [&](int i) { DeepT t(deepSrc); t.SetVal1(i); sum += t.GetVal1(); });
+Measure("CowT copy+write", count, [&](int i) { CowT t(cowSrc); t.SetVal1(i); sum += t.GetVal1(); }); // 수정한 멤버만 할당
+
+// 읽기만 하는 복사는 할당이 0회가 되고, 수정하는 경우에는 수정한 멤버만큼 할당합니다.
+// 다만 참조 카운트 증감이 atomic 연산이므로, 여러 쓰레드가 같은 Block 을 동시에 복사하면
+//  캐시 라인 경합이 생길수 있습니다. 수정이 잦다면 깊은 복제가 더 나을수 있으니 측정 후 선택하세요.
+
+/*  ClonePtr - 깊은 복제를 하는 일반화된 스마트 포인터  */
+/*
+IntPtr (복사 생성자만 지원하는 스마트 포인터), IntPtr (복사 대입 연산자까지 지원하는 
+    스마트 포인터), T::ImplPtr (스마트 포인터를 이용한 PImpl 이디엄 구현)은 모두 같은 
+    일을 합니다. 복사 생성시 복제하고, 소멸시 delete 하고, 복사 대입시 swap 합니다.
+    타입만 다를 뿐이니 템플릿 하나로 합칠수 있습니다. 
+    (앞의 IntPtr, T::ImplPtr 은 단계별 설명을 위해 그대로 둡니다. 새 코드에서는 
+    IntPtr 대신 ClonePtr<int> 를, T::ImplPtr 대신 ClonePtr<T::Impl> 을 사용하세요.)
+
+또한 기존 스마트 포인터들은
+    1. 이동 생성자와 이동 대입 연산자가 없어, 임시 개체나 std::vector 재할당시에도 
+        깊은 복제를 하고,
+    2. 4byte인 int도 힙에 생성합니다.
+
+ClonePtr<T, BufferSize>는,
+    1. 복사 생성시 복제하고, 소멸시 소멸시킵니다.
+    2. 복사 대입 연산자와 이동 대입 연산자를 값 전달 + Swap 으로 한번에 구현합니다. 
+        (copy-and-swap)
+    3. 이동 생성자, 이동 대입 연산자, Swap은 noexcept 입니다. (C++11~)
+    4. sizeof(T)가 BufferSize 이하이고, 이동 생성자가 예외를 발생하지 않는 타입이라면,
+        힙 대신 개체 내부의 m_Buffer 에 생성합니다. (Small Buffer Optimization)
+    5. 복제/이동/소멸 방법은 생성 시점에 Ops 테이블로 결정합니다. 따라서 ClonePtr 을 
+        멤버 변수로 선언하는 시점에는 T가 전방 선언만 되어 있어도 됩니다. (PImpl 이디엄 참고)
+*/
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename T, std::size_t BufferSize = 2 * sizeof(void*)>
+class ClonePtr {
+private:
+    // #5. 타입별 복제/이동/소멸 함수 테이블입니다.
+    struct Ops {
+        void (*Clone)(const ClonePtr& src, ClonePtr& dst);
+        void (*Move)(ClonePtr& src, ClonePtr& dst); // 예외를 발생하지 않습니다.
+        void (*Destroy)(ClonePtr& ptr);             // 예외를 발생하지 않습니다.
+    };
+
+    alignas(std::max_align_t) unsigned char m_Buffer[BufferSize]; // #4
+    T* m_Ptr;           // m_Buffer 나 힙 개체를 가리킵니다.
+    const Ops* m_Ops;   // NULL 이면 빈 포인터입니다.
+
+    template<typename U>
+    static constexpr bool FitsInline() {
+        return sizeof(U) <= BufferSize && 
+            alignof(U) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<U>::value;
+    }
+    static const Ops* HeapOps() {
+        static const Ops ops = {
+            [](const ClonePtr& src, ClonePtr& dst) { dst.m_Ptr = new T(*src.m_Ptr); },
+            [](ClonePtr& src, ClonePtr& dst) { dst.m_Ptr = src.m_Ptr; src.m_Ptr = nullptr; }, // 포인터만 옮깁니다.
+            [](ClonePtr& ptr) { delete ptr.m_Ptr; }
+        };
+        return &ops;
+    }
+    static const Ops* InlineOps() {
+        static const Ops ops = {
+            [](const ClonePtr& src, ClonePtr& dst) { dst.m_Ptr = new(dst.m_Buffer) T(*src.m_Ptr); },
+            [](ClonePtr& src, ClonePtr& dst) { 
+                dst.m_Ptr = new(dst.m_Buffer) T(std::move(*src.m_Ptr)); 
+                src.m_Ptr->~T();
+                src.m_Ptr = nullptr;
+            },
+            [](ClonePtr& ptr) { ptr.m_Ptr->~T(); }
+        };
+        return &ops;
+    }
+
+    ClonePtr() noexcept : m_Ptr(nullptr), m_Ops(nullptr) {}
+public:
+    // ptr : new 로 생성된 것을 전달하세요. 이미 힙에 있으므로 그대로 소유합니다.
+    explicit ClonePtr(T* ptr) :
+        m_Ptr(ptr),
+        m_Ops(ptr != nullptr ? HeapOps() : nullptr) {}
+
+    // #4. 작은 개체는 m_Buffer 에, 큰 개체는 힙에 생성합니다.
+    template<typename... Args>
+    static ClonePtr Make(Args&&... args) {
+        ClonePtr result;
+        if constexpr (FitsInline<T>()) { // C++17~: 컴파일 타임에 분기합니다.
+            result.m_Ptr = new(result.m_Buffer) T(std::forward<Args>(args)...);
+            result.m_Ops = InlineOps();
+        }
+        else {
+            result.m_Ptr = new T(std::forward<Args>(args)...);
+            result.m_Ops = HeapOps();
+        }
+        return result;
+    }
+
+    // #1. NULL 포인터가 아니라면 같은 방식(m_Buffer 나 힙)으로 복제합니다.
+    ClonePtr(const ClonePtr& other) : ClonePtr() {
+        if (other.m_Ops != nullptr) {
+            other.m_Ops->Clone(other, *this);
+            m_Ops = other.m_Ops; // (0) 복제에 성공한 뒤에 설정하므로 예외가 발생해도 빈 포인터입니다.
+        }
+    }
+    // #3. 힙 개체면 포인터만, m_Buffer 면 T 를 이동합니다. other는 빈 포인터가 됩니다.
+    ClonePtr(ClonePtr&& other) noexcept : ClonePtr() {
+        MoveFrom(other);
+    }
+    ~ClonePtr() { Reset(); }
+
+    // #2. 좌측값이면 복사 생성, 우측값이면 이동 생성된 other 와 바꿔치기 합니다.
+    ClonePtr& operator =(ClonePtr other) noexcept {
+        Swap(other);
+        return *this;
+    }   // other 는 지역 변수여서 this 가 이전에 가졌던 개체를 소멸합니다.
+
+    // #3. m_Buffer 를 사용할수 있으므로 포인터만 바꿀수는 없고, 이동 생성으로 바꿔치기 합니다.
+    void Swap(ClonePtr& other) noexcept {
+        ClonePtr temp;
+        temp.MoveFrom(other);
+        other.MoveFrom(*this);
+        MoveFrom(temp);
+    }
+
+    const T* operator ->() const { return m_Ptr; }
+    T* operator ->() { return m_Ptr; }
+
+    const T& operator *() const { return *m_Ptr; }
+    T& operator *() { return *m_Ptr; }
+
+    bool IsValid() const { return m_Ptr != nullptr ? true : false; }
+    bool IsInline() const { return m_Ptr != nullptr && static_cast<const void*>(m_Ptr) == m_Buffer; }
+private:
+    // this 는 빈 포인터여야 합니다.
+    void MoveFrom(ClonePtr& other) noexcept {
+        if (other.m_Ops == nullptr) return;
+        other.m_Ops->Move(other, *this);
+        m_Ops = other.m_Ops;
+        other.m_Ops = nullptr;
+    }
+    void Reset() noexcept {
+        if (m_Ops != nullptr) m_Ops->Destroy(*this);
+        m_Ptr = nullptr;
+        m_Ops = nullptr;
+    }
+};
+
+// ClonePtr<int> 로 IntPtr 을 대체합니다. int 는 m_Buffer 에 생성되므로 힙 할당이 없습니다.
+class T {
+    // (0) 암시적 복사 생성자, 이동 생성자, 소멸자가 ClonePtr 에서 정상 동작합니다.
+    ClonePtr<int> m_Val1;
+    ClonePtr<int> m_Val2;
+public:
+    // (0) 힙에 생성하지 않도록 int* 대신 값을 전달받습니다.
+    T(int val1, int val2) :
+        m_Val1(ClonePtr<int>::Make(val1)),
+        m_Val2(ClonePtr<int>::Make(val2)) {}
+    T(const T& other) = default;
+    T(T&& other) noexcept = default;
+
+    // 좌측값이면 복사 생성, 우측값이면 이동 생성된 other와 바꿔치기 합니다.
+    T& operator =(T other) noexcept {
+        Swap(other);
+        return *this;
+    }
+    void Swap(T& other) noexcept {
+        m_Val1.Swap(other.m_Val1);
+        m_Val2.Swap(other.m_Val2);
+    }
+
+    int GetVal1() const { return *m_Val1; }
+    int GetVal2() const { return *m_Val2; }
+};
+
+{
+    T t1(10, 20);   // (0) 힙 할당이 없습니다.
+    T t2(t1);       // (0) m_Buffer 에 복제합니다. 힙 할당이 없습니다.
+    EXPECT_TRUE(t2.GetVal1() == 10 && t2.GetVal2() == 20);
+
+    T t3(1, 2);
+    t3 = t1;            // (0) 복사 후 swap
+    EXPECT_TRUE(t3.GetVal1() == 10 && t3.GetVal2() == 20);
+
+    t3 = T(3, 4);       // (0) 이동 후 swap. 복제하지 않습니다.
+    EXPECT_TRUE(t3.GetVal1() == 3 && t3.GetVal2() == 4);
+}
+{
+    ClonePtr<int> p1 = ClonePtr<int>::Make(10);
+    ClonePtr<int> p2(new int(20));  // 이미 힙에 생성된 것은 그대로 소유합니다.
+    EXPECT_TRUE(p1.IsInline() && !p2.IsInline());
+
+    p1.Swap(p2);        // (0) 서로 다른 방식이어도 바꿔치기 할수 있습니다.
+    EXPECT_TRUE(*p1 == 20 && *p2 == 10);
+    EXPECT_TRUE(!p1.IsInline() && p2.IsInline());
+
+    ClonePtr<int> p3(std::move(p1));    // (0) 힙 개체의 포인터만 이동합니다.
+    EXPECT_TRUE(!p1.IsValid() && *p3 == 20);
+}
+// (~) 주의. m_Buffer 에 생성된 개체는 ClonePtr 과 함께 이동하므로, 이동이나 Swap 후에는 
+//  이전에 얻은 &*ptr 포인터를 사용하지 마세요.
+
+/*  std::vector 증가시 ClonePtr의 할당 측정   */
+// std::vector는 용량이 부족하면 새 메모리를 할당하고 기존 요소들을 옮깁니다. 이동 생성자가
+//  noexcept 가 아니면 예외 보증을 위해 복사 생성자로 옮기므로, IntPtr 을 사용하는 T는 
+//  재할당마다 모든 요소의 int를 다시 복제합니다.
+// 앞서 정의한 g_AllocCount, Measure() 를 사용합니다. (깊은 복제와 Copy-on-Write 측정 참고)
+#include <vector>
+
+// IntPtrT 는 IntPtr 2개를 사용하는 T, ClonePtrT 는 ClonePtr<int> 2개를 사용하는 T 입니다.
+const int count = 1000000;
+
+Measure("std::vector<IntPtrT> push_back", 1, [&](int) {
+    std::vector<IntPtrT> v;
+    for (int i = 0; i < count; ++i) {
+        v.push_back(IntPtrT(new int(i), new int(i)));   // 요소당 2회 + 재할당시 복제 2회씩 할당
+    }
+});
+Measure("std::vector<ClonePtrT> push_back", 1, [&](int) {
+    std::vector<ClonePtrT> v;
+    for (int i = 0; i < count; ++i) {
+        v.push_back(ClonePtrT(i, i));   // (0) 요소 할당 없음. 재할당시에도 이동하므로 std::vector 버퍼 할당만 있습니다.
+    }
+});
+// 출력되는 allocs/op 는 전체 push_back 루프 1회당 할당 횟수입니다. IntPtrT 는 요소 수의 
+//  수 배, ClonePtrT 는 std::vector 버퍼 재할당 횟수 (log2(count) 정도) 만큼만 할당합니다.
+// 대신 sizeof(ClonePtr<int>) 는 m_Buffer 만큼 커지므로, std::vector 버퍼는 더 커집니다.
+//  BufferSize 는 자주 담는 타입의 크기에 맞게 정하세요.
+
+/*  복사 대입 방식별 측정 - 멤버별 복사 대입, copy-and-swap, 포인터 swap  */
+/*
+swap의 복사 부하에서는 std::swap 이 복사 생성 1회와 복사 대입 2회를 한다고 했고, 
+    nothrow swap 에서는 포인터 멤버 변수를 swap 하면 복사 부하가 멤버별 복사 대입과 
+    거의 동등하다고 했습니다. 이를 Big 의 크기별로 직접 측정해 봅니다.
+
+1. Big 의 크기를 생성자로 정하고, 복사 생성/복사 대입시 복사한 바이트를 g_CopyBytes 에 
+    누적합니다. (std::cout 출력은 측정을 왜곡하므로 하지 않습니다.)
+2. 다음 3가지 T를 비교합니다.
+    MemberwiseT : Big 을 값으로 가지고, 암시적 복사 대입 연산자 (멤버별 복사 대입)
+    SwapT       : Big 을 값으로 가지고, 임시 개체 + std::swap(m_Big, temp.m_Big)
+    PtrSwapT    : Big* 를 가지고, 임시 개체 + 포인터 swap (nothrow swap 의 T)
+3. 각 T 에 대해 operator =, std::swap(t1, t2), t1.Swap(t2) 를 측정하고,
+    1회당 시간 (ns), 힙 할당 횟수, 복사한 바이트를 출력합니다.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+static std::atomic<long long> g_CopyBytes(0);  // #1. Big 을 복사한 바이트
+
+class Big {
+    std::size_t m_Size;
+    char* m_Data;   // 1. 복사 부하가 큰 데이터 입니다.
+public:
+    explicit Big(std::size_t size) :
+        m_Size(size),
+        m_Data(new char[size]) {
+        std::memset(m_Data, 0, m_Size);
+    }
+    Big(const Big& other) :
+        m_Size(other.m_Size),
+        m_Data(new char[other.m_Size]) {
+        std::memcpy(m_Data, other.m_Data, m_Size);
+        g_CopyBytes.fetch_add(m_Size, std::memory_order_relaxed); // #1
+    }
+    ~Big() { delete[] m_Data; }
+    Big& operator =(const Big& other) {
+        // 측정을 위해 크기가 같다고 가정하고 기존 버퍼에 복사합니다.
+        std::memcpy(m_Data, other.m_Data, m_Size);
+        g_CopyBytes.fetch_add(m_Size, std::memory_order_relaxed); // #1
+        return *this;
+    }
+    std::size_t GetSize() const { return m_Size; }
+};
+
+// #2. 멤버별 복사 대입
+class MemberwiseT {
+    Big m_Big;
+public:
+    explicit MemberwiseT(std::size_t size) : m_Big(size) {}
+    // 암시적 복사 대입 연산자는 m_Big = other.m_Big 입니다.
+    void Swap(MemberwiseT& other) { std::swap(m_Big, other.m_Big); } // Big 복사 생성 1회 + 복사 대입 2회
+};
+
+// #2. Big 을 값으로 가진 copy-and-swap
+class SwapT {
+    Big m_Big;
+public:
+    explicit SwapT(std::size_t size) : m_Big(size) {}
+    SwapT& operator =(const SwapT& other) {
+        SwapT temp(other);  // Big 복사 생성 1회
+        Swap(temp);         // Big 복사 생성 1회 + 복사 대입 2회
+        return *this;
+    }
+    void Swap(SwapT& other) { std::swap(m_Big, other.m_Big); }
+};
+
+// #2. Big* 를 가진 copy-and-swap (nothrow swap - 포인터 멤버 변수를 이용한 swap 최적화 참고)
+class PtrSwapT {
+    Big* m_Big;
+public:
+    explicit PtrSwapT(std::size_t size) : m_Big(new Big(size)) {}
+    PtrSwapT(const PtrSwapT& other) : m_Big(new Big(*other.m_Big)) {}
+    ~PtrSwapT() { delete m_Big; }
+    PtrSwapT& operator =(const PtrSwapT& other) {
+        PtrSwapT temp(other);   // Big 복사 생성 1회
+        Swap(temp);             // 포인터만 바꿉니다.
+        return *this;
+    }
+    void Swap(PtrSwapT& other) { std::swap(m_Big, other.m_Big); }
+};
+
+// #3. func 를 count 회 실행하고 1회당 시간, 할당 횟수, 복사 바이트를 출력합니다.
+// g_AllocCount 는 깊은 복제와 Copy-on-Write 측정에서 정의한 전역 operator new 의 카운터입니다.
+template<typename Func>
+void MeasureAssign(const char* name, std::size_t size, int count, Func func) {
+    long long allocBefore = g_AllocCount.load();
+    long long copyBefore = g_CopyBytes.load();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        func();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    std::cout << name << " size: " << size
+        << " ns/op: " << ns / count
+        << " allocs/op: " << static_cast<double>(g_AllocCount.load() - allocBefore) / count
+        << " bytes copied/op: " << static_cast<double>(g_CopyBytes.load() - copyBefore) / count 
+        << std::endl;
+}
+
+template<typename U>
+void MeasureAll(const char* name, std::size_t size, int count) {
+    U t1(size);
+    U t2(size);
+    std::string prefix(name);
+    MeasureAssign((prefix + " operator =").c_str(), size, count, [&]() { t1 = t2; });
+    MeasureAssign((prefix + " std::swap").c_str(), size, count, [&]() { std::swap(t1, t2); });
+    MeasureAssign((prefix + " Swap").c_str(), size, count, [&]() { t1.Swap(t2); });
+}
+
+const std::size_t sizes[] = { 16, 1024, 64 * 1024, 1024 * 1024 };
+for (std::size_t size : sizes) {
+    const int count = size < 64 * 1024 ? 1000000 : 1000; // 큰 Big 은 횟수를 줄입니다.
+    MeasureAll<MemberwiseT>("MemberwiseT", size, count);
+    MeasureAll<SwapT>("SwapT", size, count);
+    MeasureAll<PtrSwapT>("PtrSwapT", size, count);
+}
+/*
+예상되는 복사 바이트/할당 횟수 (size 는 Big 의 크기입니다.)
+
+                operator =              std::swap(t1, t2)           Swap()
+MemberwiseT     size, 할당 0            3 * size, 할당 1            3 * size, 할당 1
+SwapT           4 * size, 할당 2        9 * size, 할당 5            3 * size, 할당 1
+PtrSwapT        size, 할당 2            3 * size, 할당 6            0, 할당 0
+
+* MemberwiseT 와 PtrSwapT 의 operator = 는 둘다 size 만큼 복사합니다. 
+    다만 PtrSwapT 는 Big 을 새로 할당/해제하므로 size 가 작을수록 상대적으로 느립니다.
+* SwapT 처럼 값으로 가진 멤버 변수를 std::swap 하면 복사 부하가 4배가 됩니다. 
+    nothrow swap 을 써야 하는 이유입니다.
+* std::swap(t1, t2) 는 T::Swap 을 모르므로, T 에 맞는 swap 을 제공하지 않았다면 
+    PtrSwapT 도 복사 생성 1회 + 복사 대입 2회를 합니다. 
+실제 수치는 위의 출력으로 확인하시고, 크기별 결과를 보고 대입 방식을 선택하세요.
+*/
+
+/*  복사 트래픽 카운터 - std::cout 대신 복사 부하 세기  */
+/*
+nothrow swap 의 Big 은 복사 부하를 확인하려고 복사 생성/복사 대입마다 std::cout 으로 
+    출력합니다. 학습용으로는 좋지만, 출력 비용이 int 복사보다 훨씬 크므로 실제 
+    프로그램에서 복사 횟수를 세는 용도로는 쓸수 없습니다.
+
+다음처럼 카운터만 증가시키고, 필요할 때 스냅샷을 떠서 보고합니다.
+    1. 쓰레드마다 자신의 Slot 에만 기록합니다. 다른 쓰레드와 같은 캐시 라인을 쓰지 않도록
+        Slot 을 64byte 로 정렬합니다. (false sharing 방지)
+    2. 자신의 Slot 에만 쓰므로 fetch_add 같은 잠금 연산 없이 relaxed load/store 로 
+        증가시킵니다. 스냅샷을 뜨는 쓰레드가 동시에 읽어도 안전하도록 std::atomic 입니다.
+    3. 복사 횟수, 복사 바이트 외에 복사 크기의 분포를 2의 거듭제곱 구간별 히스토그램으로 
+        기록합니다.
+    4. COPY_TRAFFIC 을 정의하지 않고 빌드하면 매크로가 빈 문장이 되어 비용이 전혀 없습니다.
+    5. Snapshot() 으로 전체 쓰레드의 합계를 얻고, 두 스냅샷의 차이를 시간으로 나눠 
+        초당 복사 횟수를 보고합니다. 보고 주기에만 I/O 가 발생합니다.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+enum CopyKind {
+    CopyKind_Construct, // 복사 생성
+    CopyKind_Assign,    // 복사 대입
+    CopyKind_Count
+};
+
+class CopyTraffic {
+public:
+    static const int BucketCount = 64;  // #3. [2^(i-1), 2^i) 바이트 구간. 0번은 0 바이트
+    static const int MaxSlots = 128;    // 쓰레드 Slot 최대 개수. 넘치면 공용 Slot 을 씁니다.
+
+    // #5. 특정 시점의 합계 입니다.
+    struct Snapshot {
+        std::chrono::steady_clock::time_point m_Time;
+        std::uint64_t m_Count[CopyKind_Count];
+        std::uint64_t m_Bytes[CopyKind_Count];
+        std::uint64_t m_Histogram[CopyKind_Count][BucketCount];
+    };
+private:
+    // #1. 캐시 라인 크기로 정렬하여 쓰레드간 false sharing 을 막습니다.
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> m_Count[CopyKind_Count];
+        std::atomic<std::uint64_t> m_Bytes[CopyKind_Count];
+        std::atomic<std::uint64_t> m_Histogram[CopyKind_Count][BucketCount];
+    };
+    static Slot s_Slots[MaxSlots + 1]; // 마지막은 넘친 쓰레드들의 공용 Slot
+    static std::atomic<int> s_SlotCount;
+
+    static Slot& GetSlot() {
+        thread_local int index = -1;
+        if (index < 0) {
+            index = s_SlotCount.fetch_add(1, std::memory_order_relaxed); // 쓰레드당 1회
+            if (index > MaxSlots) index = MaxSlots;
+        }
+        return s_Slots[index];
+    }
+    static int GetBucket(std::size_t bytes) {
+        int bucket = 0;
+        while (bytes != 0) { ++bucket; bytes >>= 1; } // bit 개수
+        return bucket < BucketCount ? bucket : BucketCount - 1;
+    }
+    static void Increase(std::atomic<std::uint64_t>& counter, std::uint64_t val, bool shared) {
+        if (shared) {
+            counter.fetch_add(val, std::memory_order_relaxed); // 공용 Slot 은 여러 쓰레드가 씁니다.
+        }
+        else {
+            // #2. 자신만 쓰므로 읽고 쓰기로 충분합니다.
+            counter.store(counter.load(std::memory_order_relaxed) + val, std::memory_order_relaxed);
+        }
+    }
+public:
+    static void Record(CopyKind kind, std::size_t bytes) {
+        Slot& slot = GetSlot();
+        bool shared = &slot == &s_Slots[MaxSlots];
+        Increase(slot.m_Count[kind], 1, shared);
+        Increase(slot.m_Bytes[kind], bytes, shared);
+        Increase(slot.m_Histogram[kind][GetBucket(bytes)], 1, shared);
+    }
+
+    // #5. 모든 Slot 의 합계를 구합니다. 기록중인 쓰레드를 멈추지 않습니다.
+    static Snapshot TakeSnapshot() {
+        Snapshot result = {};
+        result.m_Time = std::chrono::steady_clock::now();
+        int slotCount = s_SlotCount.load(std::memory_order_relaxed);
+        if (slotCount > MaxSlots + 1) slotCount = MaxSlots + 1; // 공용 Slot 까지 포함합니다.
+        for (int i = 0; i < slotCount; ++i) {
+            for (int kind = 0; kind < CopyKind_Count; ++kind) {
+                result.m_Count[kind] += s_Slots[i].m_Count[kind].load(std::memory_order_relaxed);
+                result.m_Bytes[kind] += s_Slots[i].m_Bytes[kind].load(std::memory_order_relaxed);
+                for (int bucket = 0; bucket < BucketCount; ++bucket) {
+                    result.m_Histogram[kind][bucket] += s_Slots[i].m_Histogram[kind][bucket].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        return result;
+    }
+
+    // #5. prev 이후 증가분을 초당 값으로 출력합니다.
+    static void Export(std::ostream& os, const Snapshot& prev, const Snapshot& curr) {
+        static const char* names[CopyKind_Count] = { "construct", "assign" };
+        double sec = std::chrono::duration<double>(curr.m_Time - prev.m_Time).count();
+        for (int kind = 0; kind < CopyKind_Count; ++kind) {
+            os << names[kind]
+                << " copies/s: " << (curr.m_Count[kind] - prev.m_Count[kind]) / sec
+                << " bytes/s: " << (curr.m_Bytes[kind] - prev.m_Bytes[kind]) / sec
+                << " histogram:";
+            for (int bucket = 0; bucket < BucketCount; ++bucket) {
+                std::uint64_t count = curr.m_Histogram[kind][bucket] - prev.m_Histogram[kind][bucket];
+                if (count != 0) os << " <" << (bucket == 0 ? 1ULL : 1ULL << bucket) << "B:" << count;
+            }
+            os << '\n';
+        }
+    }
+};
+CopyTraffic::Slot CopyTraffic::s_Slots[CopyTraffic::MaxSlots + 1]; // 정적 변수는 0으로 초기화됩니다.
+std::atomic<int> CopyTraffic::s_SlotCount(0);
+
+// #4. COPY_TRAFFIC 이 정의되지 않으면 아무 코드도 생성하지 않습니다.
+#ifdef COPY_TRAFFIC
+#define COPY_TRAFFIC_RECORD(kind, bytes) CopyTraffic::Record((kind), (bytes))
+#else
+#define COPY_TRAFFIC_RECORD(kind, bytes) ((void)0)
+#endif
+
+// std::cout 대신 COPY_TRAFFIC_RECORD 로 기록합니다.
+class Big {
+    int m_Val;
+public:
+    explicit Big(int val) :
+        m_Val(val) {}
+    Big(const Big& other) : 
+        m_Val(other.m_Val) {
+        COPY_TRAFFIC_RECORD(CopyKind_Construct, sizeof(Big)); // (0) I/O 가 없습니다.
+    }
+    Big& operator =(const Big& other) {
+        m_Val = other.m_Val;
+        COPY_TRAFFIC_RECORD(CopyKind_Assign, sizeof(Big));
+        return *this;
+    }
+    int GetVal() const { return m_Val; }
+    void SetVal(int val) { m_Val = val; }
+};
+
+// g++ -DCOPY_TRAFFIC 로 빌드한 경우입니다.
+{
+    CopyTraffic::Snapshot prev = CopyTraffic::TakeSnapshot();
+
+    T t1(new Big(10));
+    T t2(new Big(1));
+    t2 = t1;    // Big 복사 생성 1회
+
+    CopyTraffic::Snapshot curr = CopyTraffic::TakeSnapshot();
+    EXPECT_TRUE(curr.m_Count[CopyKind_Construct] - prev.m_Count[CopyKind_Construct] == 1);
+    EXPECT_TRUE(curr.m_Count[CopyKind_Assign] - prev.m_Count[CopyKind_Assign] == 0);
+
+    CopyTraffic::Export(std::cout, prev, curr); // 보고할 때만 출력합니다.
+}
+// 실제 프로그램에서는 별도 쓰레드에서 1초마다 TakeSnapshot() 후 Export() 하면 됩니다.
+
+/*  이동 생성자와 이동 대입 연산자 - Big 을 복제하지 않고 옮기기  */
+/*
+nothrow swap 의 Big 과 T 는 복사 생성자와 복사 대입 연산자만 있습니다. 
+    그러다 보니, 
+    1. std::vector<T> 의 용량이 부족해 재할당할때,
+    2. 함수에서 T를 값으로 리턴할때 (RVO가 안되는 경우),
+    3. std::sort 가 요소들을 옮길때,
+    곧 사라질 임시 개체라도 Big 을 복제합니다.
+
+C++11~ 에서는 이동 생성자와 이동 대입 연산자로, 곧 사라질 개체의 자원을 복제하지 않고
+    가져올수 있습니다.
+    1. 이동 생성자 T(T&& other) 는 other 의 m_Big 포인터를 가져오고, other 는 NULL 로 만듭니다.
+    2. 이동 생성자는 예외를 발생하지 않으므로 noexcept 로 선언합니다. std::vector 는 
+        이동 생성자가 noexcept 일때만 재할당시 이동합니다. (예외 보증을 위해서 입니다.)
+    3. 복사 대입 연산자와 이동 대입 연산자를 값 전달 T& operator =(T other) 하나로 
+        구현합니다. 좌측값이 전달되면 other 가 복사 생성되고, 우측값이 전달되면 이동 
+        생성된 뒤 Swap 합니다.
+    4. Swap() 도 포인터끼리의 바꿔치기여서 noexcept 입니다. std::swap(t1, t2) 도 
+        이동 생성 1회, 이동 대입 2회가 되어 Big 을 복제하지 않습니다.
+    5. 이동된 개체 (m_Big 이 NULL) 는 소멸하거나 다른 값을 대입하는 것만 허용합니다.
+*/
+class Big {
+    int m_Val;
+public:
+    explicit Big(int val) :
+        m_Val(val) {}
+    Big(const Big& other) : 
+        m_Val(other.m_Val) {
+        COPY_TRAFFIC_RECORD(CopyKind_Construct, sizeof(Big)); // 복사 트래픽 카운터 참고
+    }
+    Big(Big&& other) noexcept : 
+        m_Val(other.m_Val) {} // int 여서 이동과 복사가 같습니다. 복제된 횟수에는 세지 않습니다.
+    Big& operator =(const Big& other) {
+        m_Val = other.m_Val;
+        COPY_TRAFFIC_RECORD(CopyKind_Assign, sizeof(Big));
+        return *this;
+    }
+    Big& operator =(Big&& other) noexcept {
+        m_Val = other.m_Val;
+        return *this;
+    }
+    int GetVal() const { return m_Val; }
+    void SetVal(int val) { m_Val = val; }
+};
+class T {
+    Big* m_Big;
+public:
+    explicit T(Big* big) : 
+        m_Big(big) {}
+    // NULL 포인터가 아니라면 복제합니다.
+    T(const T& other) :
+        m_Big(other.m_Big != NULL ? new Big(*other.m_Big) : NULL) {}
+    // #1, #2. 포인터만 가져옵니다. Big 을 복제하지 않습니다.
+    T(T&& other) noexcept :
+        m_Big(other.m_Big) {
+        other.m_Big = NULL; // other 가 소멸될때 delete 하지 않도록 합니다.
+    }
+    ~T() {
+        delete m_Big;
+    }
+
+    // #3. 좌측값이면 복사 생성, 우측값이면 이동 생성된 other 와 바꿔치기 합니다.
+    T& operator =(T other) noexcept {
+        Swap(other);
+        return *this;
+    }   // other 는 지역 변수여서 this 가 이전에 가졌던 Big 을 소멸합니다.
+
+    // #4.
+    void Swap(T& other) noexcept {
+        std::swap(this->m_Big, other.m_Big);
+    }
+
+    const Big* GetBig() const { return m_Big; }
+};
+// std::sort 에서 사용합니다.
+bool operator <(const T& left, const T& right) {
+    return left.GetBig()->GetVal() < right.GetBig()->GetVal();
+}
+
+{
+    T t1(new Big(10));
+    T t2(new Big(1));
+    t2 = t1;                // (0) other 를 복사 생성합니다. Big 복사 1회
+    EXPECT_TRUE(t2.GetBig()->GetVal() == 10);
+
+    t2 = T(new Big(20));    // (0) other 를 이동 생성합니다. Big 복사 없음
+    EXPECT_TRUE(t2.GetBig()->GetVal() == 20);
+
+    T t3(std::move(t1));    // (0) 이동 생성. Big 복사 없음
+    EXPECT_TRUE(t3.GetBig()->GetVal() == 10);
+    EXPECT_TRUE(t1.GetBig() == NULL);   // #5. 이동된 t1은 더이상 사용하지 않습니다.
+}
+
+/*  std::vector<T> 추가와 정렬시 Big 복사 횟수 측정    */
+// COPY_TRAFFIC 을 정의하고 빌드하여 복사 트래픽 카운터로 Big 복사 횟수를 셉니다.
+//  (복사 트래픽 카운터 참고)
+// CopyOnlyT 는 nothrow swap 의 T (이동 연산 없음), MovableT 는 상기 T 입니다.
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+template<typename U>
+void MeasurePushAndSort(const char* name, int count) {
+    CopyTraffic::Snapshot begin = CopyTraffic::TakeSnapshot();
+
+    std::vector<U> v;
+    for (int i = 0; i < count; ++i) {
+        v.push_back(U(new Big(std::rand()))); // 재할당시 기존 요소를 옮깁니다.
+    }
+    CopyTraffic::Snapshot pushed = CopyTraffic::TakeSnapshot();
+
+    std::sort(v.begin(), v.end());  // 요소를 swap, 이동 대입합니다.
+    CopyTraffic::Snapshot sorted = CopyTraffic::TakeSnapshot();
+
+    std::cout << name 
+        << " push_back Big copies: " << pushed.m_Count[CopyKind_Construct] - begin.m_Count[CopyKind_Construct]
+        << " sort Big copies: " << sorted.m_Count[CopyKind_Construct] - pushed.m_Count[CopyKind_Construct]
+        << " push_back ms: " << std::chrono::duration<double, std::milli>(pushed.m_Time - begin.m_Time).count()
+        << " sort ms: " << std::chrono::duration<double, std::milli>(sorted.m_Time - pushed.m_Time).count()
+        << std::endl;
+}
+
+MeasurePushAndSort<CopyOnlyT>("CopyOnlyT", 1000000);
+MeasurePushAndSort<MovableT>("MovableT", 1000000);
+// CopyOnlyT 는 임시 개체를 push_back 할때 1회, 재할당마다 기존 요소 수만큼 복사하고, 
+//  sort 에서도 요소를 옮길때마다 복사합니다. (요소수 * log 요소수 정도)
+// MovableT 는 push_back 과 sort 모두 Big 복사가 0회여야 합니다. 0이 아니라면 어딘가에서 
+//  이동 연산이 noexcept 가 아니거나, 좌측값을 전달하고 있는 것입니다.
+
+/*  기존 버퍼를 재사용하는 예외 보증 복사 대입 연산자   */
+/*
+swap 을 이용한 복사 대입 연산자는 항상 T temp(other) 로 Big 을 새로 할당합니다. 
+    this 가 이미 같은 크기의 Big 을 가지고 있어도 할당하고, 이전 Big 은 해제합니다.
+    Big 이 크면 복사보다 할당/해제 비용이 더 클수도 있습니다.
+
+예외 보증을 해치지 않으면서 할당을 줄이려면,
+    1. 기존 Big 에 복사해도 예외가 발생하지 않는 경우 (크기가 같아 memcpy 만 하면 되는 경우)
+        에는 그대로 복사합니다. 중간에 실패할 일이 없으므로 강한 예외 보증이 됩니다.
+    2. 그렇지 않은 경우 (크기가 달라 할당이 필요한 경우) 에만 copy-and-swap 을 합니다.
+        할당에 실패해도 this 는 그대로 입니다.
+    3. 값 전달 대입 연산자 (T& operator =(T other)) 는 호출 전에 other 를 복사 생성하므로 
+        기존 버퍼를 재사용할수 없습니다. 따라서 복사 대입 연산자와 이동 대입 연산자를 
+        따로 구현합니다.
+*/
+#include <cstring>
+
+class Big {
+    std::size_t m_Size;
+    char* m_Data;
+public:
+    explicit Big(std::size_t size) :
+        m_Size(size),
+        m_Data(new char[size]()) {}
+    Big(const Big& other) :
+        m_Size(other.m_Size),
+        m_Data(new char[other.m_Size]) {
+        std::memcpy(m_Data, other.m_Data, m_Size);
+    }
+    ~Big() { delete[] m_Data; }
+
+    // #1. 크기가 같으면 할당 없이 복사하고 true 를 리턴합니다. 예외를 발생하지 않습니다.
+    bool TryAssign(const Big& other) noexcept {
+        if (m_Size != other.m_Size) return false;
+        std::memcpy(m_Data, other.m_Data, m_Size);
+        return true;
+    }
+    Big& operator =(const Big& other) {
+        if (!TryAssign(other)) {
+            Big temp(other);    // #2. 크기가 다르면 할당이 필요하므로 copy-and-swap 합니다.
+            Swap(temp);
+        }
+        return *this;
+    }
+    void Swap(Big& other) noexcept {
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Data, other.m_Data);
+    }
+    std::size_t GetSize() const { return m_Size; }
+    char GetAt(std::size_t index) const { return m_Data[index]; }
+    void SetAt(std::size_t index, char val) { m_Data[index] = val; }
+};
+
+class T {
+    Big* m_Big;
+public:
+    explicit T(Big* big) : 
+        m_Big(big) {}
+    T(const T& other) :
+        m_Big(other.m_Big != NULL ? new Big(*other.m_Big) : NULL) {}
+    T(T&& other) noexcept :
+        m_Big(other.m_Big) {
+        other.m_Big = NULL;
+    }
+    ~T() { delete m_Big; }
+
+    T& operator =(const T& other) {
+        if (this == &other) return *this;
+
+        // #1. 예외가 발생하지 않는 경우만 기존 Big 에 복사합니다.
+        if (m_Big != NULL && other.m_Big != NULL && m_Big->TryAssign(*other.m_Big)) {
+            return *this;
+        }
+        // #2. 할당이 필요하면 copy-and-swap 합니다. 예외가 발생해도 this 는 그대로 입니다.
+        T temp(other);
+        Swap(temp);
+        return *this;
+    }
+    // #3. 이동 대입 연산자는 포인터만 바꿉니다.
+    T& operator =(T&& other) noexcept {
+        T temp(std::move(other));
+        Swap(temp);
+        return *this;
+    }
+    void Swap(T& other) noexcept {
+        std::swap(this->m_Big, other.m_Big);
+    }
+
+    const Big* GetBig() const { return m_Big; }
+};
+
+{
+    T t1(new Big(1024));
+    T t2(new Big(1024));
+    const Big* before = t2.GetBig();
+    t2 = t1;    // (0) 크기가 같아 기존 Big 에 복사합니다. 할당 없음
+    EXPECT_TRUE(t2.GetBig() == before);
+
+    T t3(new Big(16));
+    t3 = t1;    // (0) 크기가 달라 copy-and-swap 합니다.
+    EXPECT_TRUE(t3.GetBig()->GetSize() == 1024);
+}
+// (~) 주의. TryAssign() 처럼 예외가 발생하지 않는다는 것이 보장될 때만 기존 버퍼에 복사하세요.
+//  Big 의 복사 대입 연산자가 중간에 예외를 발생할수 있다면 (예를 들어 멤버 변수가 여러개이고,
+//  각각 할당이 필요하다면), 일부만 복사된 상태가 되어 예외 보증이 깨집니다.
+//  일반화된 코드에서는 std::is_nothrow_copy_assignable<Big>::value 로 검사할수 있습니다.
+
+/*  반복 대입 측정 - copy-and-swap 과 버퍼 재사용  */
+// 깊은 복제와 Copy-on-Write 측정의 g_AllocCount, Measure() 를 사용합니다.
+// SwapT 는 nothrow swap 의 T 처럼 항상 copy-and-swap 하고, ReuseT 는 상기 T 입니다. 
+//  같은 데이터를 비교하도록 둘다 상기 Big (size 바이트 버퍼) 을 사용합니다.
+class SwapT {
+    Big* m_Big;
+public:
+    explicit SwapT(Big* big) : 
+        m_Big(big) {}
+    SwapT(const SwapT& other) :
+        m_Big(other.m_Big != NULL ? new Big(*other.m_Big) : NULL) {}
+    ~SwapT() { delete m_Big; }
+
+    SwapT& operator =(const SwapT& other) {
+        SwapT temp(other); // 크기가 같아도 항상 할당합니다.
+        std::swap(m_Big, temp.m_Big);
+        return *this;
+    }
+};
+typedef T ReuseT;
+
+const std::size_t sizes[] = { 64, 4 * 1024, 256 * 1024, 16 * 1024 * 1024 };
+for (std::size_t size : sizes) {
+    const int count = size < 256 * 1024 ? 100000 : 100;
+    SwapT swapSrc(new Big(size));
+    SwapT swapDst(new Big(size));
+    ReuseT reuseSrc(new Big(size));
+    ReuseT reuseDst(new Big(size));
+
+    std::cout << "size: " << size << std::endl;
+    Measure("SwapT operator =", count, [&](int) { swapDst = swapSrc; });     // 2회 할당/해제 (T::Big, Big::m_Data)
+    Measure("ReuseT operator =", count, [&](int) { reuseDst = reuseSrc; });  // 할당 없음
+}
+// 큰 Big 에서는 할당/해제가 mmap/munmap 이 되어 페이지 폴트 비용까지 더해지므로, 
+//  차이가 더 커질수 있습니다.
+
+/*  큰 Big 의 복사 - SIMD 복사 함수와 non-temporal 저장  */
+/*
+지금까지의 Big 은 int m_Val 하나나 작은 버퍼로 "복사 부하가 큰 데이터" 를 흉내만 
+    냈습니다. 수 KB 에서 수백 MB 까지의 실제 데이터라면 복사 방법 자체가 성능을 좌우합니다.
+
+    1. Big 은 64byte 로 정렬된 m_Size 바이트 버퍼를 가집니다. (C++17~: 정렬 지정 new)
+    2. 복사 함수는 실행중인 CPU 에 맞게 한번만 선택합니다. 
+        AVX2 를 지원하면 32byte 씩, 아니면 SSE2 로 16byte 씩 복사하고, 
+        둘다 없으면 8byte 씩 복사하는 scalar 함수를 사용합니다. (GCC/Clang 의 
+        __builtin_cpu_supports 와 target 속성을 사용합니다. 다른 컴파일러는 scalar 함수만 
+        사용합니다.)
+    3. 크기가 NonTemporalThreshold 이상이면 non-temporal (streaming) 저장을 사용합니다.
+        일반 저장은 대상 메모리를 캐시에 올리므로, 캐시보다 큰 데이터를 복사하면 
+        다른 데이터를 캐시에서 밀어냅니다. streaming 저장은 캐시를 거치지 않고 메모리에 
+        바로 씁니다. 마지막에 _mm_sfence() 로 저장 순서를 보장합니다.
+    4. 크기가 작으면 std::memcpy 를 그대로 사용합니다. 함수 선택 비용과 꼬리 처리 비용이 
+        더 큽니다.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BIG_COPY_X86 1
+#endif
+
+class BigCopy {
+public:
+    typedef void (*CopyFunc)(char* dst, const char* src, std::size_t size, bool nonTemporal);
+
+    static const std::size_t Alignment = 64; // #1
+    static const std::size_t SmallSize = 256; // #4. 이보다 작으면 std::memcpy 를 사용합니다.
+
+    // #3. 기본값은 일반적인 LLC 크기 정도 입니다. 측정후 조정하세요.
+    static std::size_t& NonTemporalThreshold() {
+        static std::size_t threshold = 8 * 1024 * 1024;
+        return threshold;
+    }
+
+    static void Copy(char* dst, const char* src, std::size_t size) {
+        if (size < SmallSize) {
+            std::memcpy(dst, src, size);
+            return;
+        }
+        static const CopyFunc func = Select(); // #2. 처음 한번만 선택합니다.
+        func(dst, src, size, size >= NonTemporalThreshold());
+    }
+
+    // scalar 구현입니다. SIMD 가 없는 환경에서 사용하고, 측정 기준으로도 사용합니다. 
+    // 컴파일러가 루프를 std::memcpy 호출로 바꾸거나 (GCC 의 loop distribution, Clang 의 
+    //  loop idiom) 벡터화하지 않도록 막습니다.
+#if defined(__clang__)
+    __attribute__((no_builtin("memcpy")))
+#elif defined(__GNUC__)
+    __attribute__((optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+#endif
+    static void CopyScalar(char* dst, const char* src, std::size_t size, bool) {
+        std::size_t i = 0;
+#if defined(__clang__)
+#pragma clang loop vectorize(disable) interleave(disable)
+#endif
+        for (; i + 8 <= size; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, src + i, sizeof(word)); // 8byte 읽기/쓰기 명령 1개씩으로 컴파일됩니다.
+            std::memcpy(dst + i, &word, sizeof(word));
+        }
+        for (; i < size; ++i) dst[i] = src[i]; // 8byte 미만의 꼬리
+    }
+
+    // 표준 라이브러리의 std::memcpy 입니다. 비교용으로만 측정합니다. 
+    // (~) glibc 등은 std::memcpy 를 SIMD 로 구현하므로 scalar 가 아닙니다. 
+    //  nonTemporal 은 무시하며, streaming 저장 여부는 라이브러리가 정합니다.
+    static void CopyLibc(char* dst, const char* src, std::size_t size, bool) {
+        std::memcpy(dst, src, size);
+    }
+
+#ifdef BIG_COPY_X86
+    // dst 는 Alignment 로 정렬되어 있어야 합니다. (Big 의 버퍼는 정렬되어 있습니다.)
+    __attribute__((target("sse2")))
+    static void CopySse2(char* dst, const char* src, std::size_t size, bool nonTemporal) {
+        std::size_t i = 0;
+        if (nonTemporal) {
+            for (; i + 64 <= size; i += 64) { // 캐시 라인 단위로 4개씩 복사합니다.
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), a);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+            }
+            _mm_sfence(); // #3. streaming 저장이 다른 저장보다 먼저 보이도록 합니다.
+        }
+        else {
+            for (; i + 64 <= size; i += 64) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), a);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+            }
+        }
+        std::memcpy(dst + i, src + i, size - i); // 64byte 미만의 꼬리
+    }
+
+    __attribute__((target("avx2")))
+    static void CopyAvx2(char* dst, const char* src, std::size_t size, bool nonTemporal) {
+        std::size_t i = 0;
+        if (nonTemporal) {
+            for (; i + 64 <= size; i += 64) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), a);
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+            }
+            _mm_sfence();
+        }
+        else {
+            for (; i + 64 <= size; i += 64) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), a);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+            }
+        }
+        _mm256_zeroupper(); // SSE 코드로 돌아갈때의 전환 비용을 없앱니다.
+        std::memcpy(dst + i, src + i, size - i);
+    }
+#endif
+
+    static CopyFunc Select() {
+#ifdef BIG_COPY_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return &CopyAvx2;
+        if (__builtin_cpu_supports("sse2")) return &CopySse2;
+#endif
+        return &CopyScalar;
+    }
+};
+
+class Big {
+    std::size_t m_Size;
+    char* m_Data; // #1. BigCopy::Alignment 로 정렬되어 있습니다.
+
+    static char* Allocate(std::size_t size) {
+        return static_cast<char*>(::operator new(size, std::align_val_t(BigCopy::Alignment)));
+    }
+    static void Deallocate(char* data) {
+        ::operator delete(data, std::align_val_t(BigCopy::Alignment));
+    }
+public:
+    explicit Big(std::size_t size) :
+        m_Size(size),
+        m_Data(Allocate(size)) {
+        std::memset(m_Data, 0, m_Size);
+    }
+    Big(const Big& other) :
+        m_Size(other.m_Size),
+        m_Data(Allocate(other.m_Size)) {
+        BigCopy::Copy(m_Data, other.m_Data, m_Size);
+    }
+    Big(Big&& other) noexcept :
+        m_Size(other.m_Size),
+        m_Data(other.m_Data) {
+        other.m_Size = 0;
+        other.m_Data = NULL;
+    }
+    ~Big() { Deallocate(m_Data); }
+
+    Big& operator =(const Big& other) {
+        if (this == &other) return *this;
+        if (m_Size == other.m_Size) {
+            BigCopy::Copy(m_Data, other.m_Data, m_Size); // 크기가 같으면 예외 없이 복사합니다.
+        }
+        else {
+            Big temp(other);
+            Swap(temp);
+        }
+        return *this;
+    }
+    Big& operator =(Big&& other) noexcept {
+        Big temp(std::move(other));
+        Swap(temp);
+        return *this;
+    }
+    void Swap(Big& other) noexcept {
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Data, other.m_Data);
+    }
+
+    std::size_t GetSize() const { return m_Size; }
+    char GetAt(std::size_t index) const { return m_Data[index]; }
+    void SetAt(std::size_t index, char val) { m_Data[index] = val; }
+    const char* GetData() const { return m_Data; }
+    char* GetData() { return m_Data; }
+};
+
+{
+    Big b1(1000003); // 64byte 로 나누어 떨어지지 않는 크기도 꼬리까지 복사합니다.
+    for (std::size_t i = 0; i < b1.GetSize(); ++i) b1.SetAt(i, static_cast<char>(i));
+
+    Big b2(b1);
+    EXPECT_TRUE(b2.GetAt(0) == b1.GetAt(0) && b2.GetAt(1000002) == b1.GetAt(1000002));
+
+    std::size_t threshold = BigCopy::NonTemporalThreshold();
+    BigCopy::NonTemporalThreshold() = 0; // streaming 저장 경로도 같은 결과여야 합니다.
+    Big b3(b1);
+    BigCopy::NonTemporalThreshold() = threshold;
+    EXPECT_TRUE(std::memcmp(b3.GetData(), b1.GetData(), b1.GetSize()) == 0);
+}
+
+/*  복사 대역폭 측정 (GB/s)   */
+// 크기별로 scalar, std::memcpy (libc), SSE2, AVX2 함수와 일반/streaming 저장을 각각 측정합니다.
+//  복사 1회당 읽기 size + 쓰기 size 이지만, 관례에 따라 size / 시간 으로 출력합니다.
+#include <algorithm>
+#include <chrono>
+
+void MeasureBandwidth(const char* name, BigCopy::CopyFunc func, std::size_t size, bool nonTemporal) {
+    Big src(size);
+    Big dst(size);
+    const int count = static_cast<int>(std::max<std::size_t>(1, (std::size_t(1) << 32) / size)); // 4GB 정도 복사합니다.
+    char* d = dst.GetData();
+    const char* s = src.GetData();
+
+    func(d, s, size, nonTemporal); // 첫 복사는 페이지 폴트가 포함되므로 제외합니다.
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        func(d, s, size, nonTemporal);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - begin).count();
+    std::cout << name << (nonTemporal ? " stream" : " store") 
+        << " size: " << size 
+        << " GB/s: " << static_cast<double>(size) * count / sec / 1e9 << std::endl;
+}
+
+const std::size_t sizes[] = { 4 * 1024, 256 * 1024, 4 * 1024 * 1024, 64 * 1024 * 1024, 512 * 1024 * 1024 };
+for (std::size_t size : sizes) {
+    for (bool nonTemporal : { false, true }) {
+        MeasureBandwidth("scalar", &BigCopy::CopyScalar, size, nonTemporal);
+        MeasureBandwidth("libc", &BigCopy::CopyLibc, size, nonTemporal);
+#ifdef BIG_COPY_X86
+        MeasureBandwidth("sse2", &BigCopy::CopySse2, size, nonTemporal);
+        if (__builtin_cpu_supports("avx2")) MeasureBandwidth("avx2", &BigCopy::CopyAvx2, size, nonTemporal);
+#endif
+    }
+}
+// 작은 크기는 캐시 안에서 복사되므로 일반 저장이 빠르고, LLC 보다 큰 크기에서는 streaming 
+//  저장이 빨라지거나 비슷해 집니다. 두 곡선이 교차하는 크기로 NonTemporalThreshold 를 정하세요.
+// 또한 streaming 복사 중에 다른 쓰레드의 작업이 캐시 미스로 느려지지 않는지도 함께 확인하세요.
+// scalar 행이 SIMD 를 사용하지 않는 기준입니다. scalar 와 sse2/avx2 의 차이가 SIMD 의 효과 입니다.
+// (~) 주의. libc 행은 이미 SIMD 로 구현된 std::memcpy 여서, 캐시 안의 크기에서는 sse2/avx2 
+//  보다 빠를수도 있습니다. 직접 구현한 함수의 이점은 주로 큰 크기에서 streaming 저장을 
+//  언제 쓸지 직접 정할수 있다는 것입니다. scalar, libc 의 stream/store 행은 nonTemporal 을 
+//  무시하므로 같은 함수의 측정입니다.
+
+/*  여러 쓰레드에서의 읽기/대입 - 시퀀스 잠금 (seqlock)   */
+/*
+swap 을 이용한 예외 보증 복사 대입 연산자의 T (m_X, m_Y) 는 한 쓰레드가 대입하는 동안 
+    다른 쓰레드가 GetX(), GetY() 를 호출하면, 새 m_X 와 이전 m_Y 처럼 섞인 값을 읽을수 
+    있습니다. (사실 동시에 읽고 쓰는 것 자체가 data race 여서 미정의 동작입니다.)
+mutex 로 보호하면 안전하지만, int 2개를 읽는데 매번 잠금을 하면 읽는 쓰레드들끼리도 
+    mutex 를 두고 경합하여 읽기 성능이 크게 떨어집니다.
+
+읽기가 대부분이고 데이터가 작다면 시퀀스 잠금을 사용할수 있습니다.
+    1. m_Seq 는 쓰는 중이면 홀수, 아니면 짝수입니다.
+    2. 쓰는 쪽은 m_Seq 를 홀수로 만들고, 값을 쓰고, 다시 짝수로 만듭니다. 쓰는 쪽끼리는 
+        m_WriteMutex 로 직렬화합니다.
+    3. 읽는 쪽은 잠금 없이 m_Seq 를 읽고, 값을 읽고, m_Seq 를 다시 읽습니다. 
+        처음 m_Seq 가 홀수이거나 두 m_Seq 가 다르면 쓰는 중에 읽은 것이므로 다시 읽습니다.
+        읽는 쪽은 공유 메모리에 쓰지 않으므로, 읽는 쓰레드가 늘어도 서로 경합하지 않습니다.
+    4. 값 자체도 std::atomic 으로 relaxed 읽기/쓰기 하여 data race 가 없게 합니다.
+        순서는 m_Seq 와 메모리 펜스로 보장합니다.
+    5. 쓰는 쪽은 Swap() 으로 공개합니다. 복사 대입 연산자는 임시 개체에 일관된 값을 
+        읽어온 뒤 Swap 합니다. (copy-and-swap)
+*/
+#include <atomic>
+#include <mutex>
+
+class ConcurrentT {
+    std::atomic<unsigned> m_Seq; // #1
+    std::atomic<int> m_X;        // #4
+    std::atomic<int> m_Y;
+    std::mutex m_WriteMutex;     // #2. 쓰는 쪽끼리만 사용합니다.
+public:
+    ConcurrentT(int x, int y) :
+        m_Seq(0),
+        m_X(x),
+        m_Y(y) {}
+    ConcurrentT(const ConcurrentT& other) :
+        m_Seq(0),
+        m_X(0),
+        m_Y(0) {
+        int x, y;
+        other.Read(x, y);   // 일관된 값을 읽어 옵니다.
+        m_X.store(x, std::memory_order_relaxed);
+        m_Y.store(y, std::memory_order_relaxed);
+    }
+
+    // #5. 일관된 값을 읽어 만든 임시 개체와 바꿔치기 합니다.
+    ConcurrentT& operator =(const ConcurrentT& other) {
+        if (this == &other) return *this;
+        ConcurrentT temp(other);
+        Swap(temp);
+        return *this;
+    }
+
+    // #2, #5. this 는 여러 쓰레드가 공유하고, other 는 호출한 쓰레드만 사용하는 지역 개체여야 합니다.
+    void Swap(ConcurrentT& other) {
+        std::lock_guard<std::mutex> lock(m_WriteMutex);
+
+        int x = other.m_X.load(std::memory_order_relaxed);
+        int y = other.m_Y.load(std::memory_order_relaxed);
+
+        unsigned seq = m_Seq.load(std::memory_order_relaxed);
+        m_Seq.store(seq + 1, std::memory_order_relaxed);        // 홀수. 쓰는 중입니다.
+        std::atomic_thread_fence(std::memory_order_release);    // 값 쓰기가 홀수 m_Seq 보다 먼저 보이지 않게 합니다.
+
+        other.m_X.store(m_X.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.m_Y.store(m_Y.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_X.store(x, std::memory_order_relaxed);
+        m_Y.store(y, std::memory_order_relaxed);
+
+        m_Seq.store(seq + 2, std::memory_order_release);        // 짝수. 값 쓰기 이후에 보입니다.
+    }
+
+    // #3. 잠금 없이 일관된 (m_X, m_Y) 를 읽습니다.
+    void Read(int& x, int& y) const {
+        unsigned before;
+        unsigned after;
+        do {
+            before = m_Seq.load(std::memory_order_acquire);
+            x = m_X.load(std::memory_order_relaxed);
+            y = m_Y.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire); // 값 읽기가 두번째 m_Seq 읽기보다 늦어지지 않게 합니다.
+            after = m_Seq.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+    }
+
+    // 각각은 원자적으로 읽지만, GetX() 와 GetY() 사이에 대입될수 있습니다. 둘다 필요하면 Read() 를 사용하세요.
+    int GetX() const { return m_X.load(std::memory_order_acquire); }
+    int GetY() const { return m_Y.load(std::memory_order_acquire); }
+};
+
+{
+    ConcurrentT t1(10, 20);
+    ConcurrentT t2(1, 2);
+    t2 = t1;
+    int x, y;
+    t2.Read(x, y);
+    EXPECT_TRUE(x == 10 && y == 20);
+}
+
+/*  여러 쓰레드 읽기, 쓰레드 1개 쓰기 시험   */
+// 쓰는 쪽은 항상 (i, -i) 를 대입합니다. 읽는 쪽은 x == -y 가 아닌 섞인 값을 읽으면 안됩니다.
+#include <thread>
+#include <vector>
+
+{
+    ConcurrentT shared(0, 0);
+    std::atomic<bool> stop(false);
+    std::atomic<long long> torn(0);     // 섞인 값을 읽은 횟수
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.push_back(std::thread([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                int x, y;
+                shared.Read(x, y);
+                if (x != -y) torn.fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+    }
+    std::thread writer([&]() {
+        for (int i = 1; i <= 10000000; ++i) {
+            ConcurrentT temp(i, -i);
+            shared.Swap(temp);
+        }
+        stop.store(true, std::memory_order_relaxed);
+    });
+
+    writer.join();
+    for (std::size_t i = 0; i < readers.size(); ++i) readers[i].join();
+
+    EXPECT_TRUE(torn.load() == 0);
+    int x, y;
+    shared.Read(x, y);
+    EXPECT_TRUE(x == 10000000 && y == -10000000);
+}
+
+/*  읽기 쓰레드 수에 따른 처리량 측정 - mutex 와 seqlock  */
+// MutexT 는 GetX/GetY 를 함께 mutex 로 보호한 T 입니다. 읽기 쓰레드를 1, 2, 4, ... 
+//  hardware_concurrency - 1 개로 늘리면서 (마지막은 항상 hardware_concurrency - 1 개, 
+//  코어가 1개 이하면 1개), 쓰기 쓰레드 1개가 계속 대입하는 동안 1초간 읽은 횟수를 출력합니다.
+#include <algorithm>
+#include <chrono>
+
+template<typename U>
+void MeasureReadThroughput(const char* name, int readerCount) {
+    U shared(0, 0);
+    std::atomic<bool> stop(false);
+    std::atomic<long long> totalReads(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < readerCount; ++i) {
+        readers.push_back(std::thread([&]() {
+            long long reads = 0; // 쓰레드 지역 변수로 세고 마지막에 합칩니다.
+            int x, y;
+            while (!stop.load(std::memory_order_relaxed)) {
+                shared.Read(x, y);
+                ++reads;
+            }
+            totalReads.fetch_add(reads);
+        }));
+    }
+    std::thread writer([&]() {
+        for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            U temp(i, -i);
+            shared.Swap(temp);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    stop.store(true);
+    writer.join();
+    for (std::size_t i = 0; i < readers.size(); ++i) readers[i].join();
+
+    std::cout << name << " readers: " << readerCount 
+        << " reads/s: " << totalReads.load() << std::endl;
+}
+
+// hardware_concurrency() 는 알수 없으면 0 입니다. 쓰기 쓰레드 몫을 빼도 읽기 쓰레드는 최소 1개 입니다.
+const int maxReaders = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+for (int readerCount = 1; readerCount <= maxReaders; 
+    readerCount = readerCount == maxReaders ? maxReaders + 1 : std::min(readerCount * 2, maxReaders)) {
+    MeasureReadThroughput<MutexT>("MutexT", readerCount);
+    MeasureReadThroughput<ConcurrentT>("ConcurrentT", readerCount);
+}
+// seqlock 은 읽기 쓰레드 수에 비례해 처리량이 늘어나야 합니다. mutex 는 쓰레드가 늘수록 
+//  잠금 경합으로 오히려 줄어들수 있습니다.
+// (~) 주의. 쓰기가 매우 잦으면 읽는 쪽이 계속 다시 읽게 되어 느려집니다. 또한 seqlock 은 
+//  복사가 싸고 포인터를 따라가지 않는 작은 값에만 사용하세요. 읽는 도중 값이 바뀔수 
+//  있으므로, 읽은 포인터를 역참조하면 해제된 메모리에 접근할수 있습니다.
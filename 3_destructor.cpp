@@ -143,3 +143,220 @@ Derived* d = new Derived;
 Base* b = d;
 delete b;   // (0) 1, 2 호출됨. 다형 소멸 지원.
 
+
+/*      프레임 단위 할당과 소멸 생략 - std::pmr      */
+/*
+매 프레임마다 도형들을 new 로 만들고 delete 로 다형 소멸하면, 도형 수만큼 할당, 가상 소멸자 
+    호출, 해제가 일어납니다. 프레임이 끝나면 모두 버리므로, C++17 의 std::pmr 메모리 
+    리소스에서 할당하고 한번에 해제할수 있습니다.
+
+    1. FrameScope<Resource> 는 메모리 리소스 (std::pmr::monotonic_buffer_resource 또는 
+        std::pmr::unsynchronized_pool_resource) 에서 개체를 생성합니다. 
+        Release() 나 소멸자에서 Resource::release() 로 메모리를 한번에 해제합니다.
+    2. 개체의 소멸자는 하는 일이 없을때만 생략할수 있습니다. IsTriviallyReleasable<T> 가 
+        true 이면 소멸자 호출을 생략하고, 아니면 소멸자 호출을 목록에 기록해 두었다가 
+        Release() 에서 생성의 역순으로 호출합니다.
+    3. 가상 소멸자가 있는 도형은 std::is_trivially_destructible 이 아니므로 직접 지정해야 
+        합니다. 도형의 소멸자가 하는 일은 멤버 변수의 소멸 뿐이므로, Shape 의 멤버를 
+        Shape::Data 1개로 묶고, ReleasableShape<T> 로 다음을 컴파일 타임에 확인합니다.
+            - Shape::Data 는 소멸자가 하는 일이 없습니다. (std::is_trivially_destructible)
+            - Shape 에는 Data 외의 멤버가 없고, T 는 Shape 에 멤버를 추가하지 않았습니다.
+        Data 의 int 를 std::unique_ptr<int> 로 바꾸거나 Rectangle 에 std::string 을 추가하면 
+        컴파일 오류입니다. std::string 멤버가 있는 Label 은 지정하지 않으므로 소멸자를 
+        호출합니다.
+    4. FrameScope 로 생성한 개체는 delete 하면 안됩니다. (new 로 할당하지 않았습니다.)
+    5. monotonic_buffer_resource 에 미리 할당한 버퍼를 주면, release() 후 다음 프레임에서 
+        그 버퍼를 처음부터 다시 사용하므로 프레임마다 힙 할당이 없습니다.
+*/
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+class Shape {
+public:
+    struct Data { // #3. Shape 의 멤버 변수들 입니다.
+        int m_Left;
+        int m_Top;
+        int m_Width;
+        int m_Height;
+    };
+private:
+    Data m_Data;
+protected:
+    Shape(int l, int t, int w, int h) : m_Data{ l, t, w, h } {}
+public:
+    virtual ~Shape() {} // 다형 소멸을 지원함
+    virtual int GetArea() const = 0;
+    int GetWidth() const { return m_Data.m_Width; }
+    int GetHeight() const { return m_Data.m_Height; }
+};
+class Rectangle : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual int GetArea() const { return GetWidth() * GetHeight(); }
+};
+class Ellipse : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual int GetArea() const { return GetWidth() * GetHeight() * 785 / 1000; }
+};
+class Triangle : public Shape {
+public:
+    Triangle(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual int GetArea() const { return GetWidth() * GetHeight() / 2; }
+};
+class Label : public Shape {
+    std::string m_Text; // 소멸자에서 해제해야 합니다.
+public:
+    Label(int l, int t, const std::string& text) : Shape(l, t, 0, 0), m_Text(text) {}
+    virtual int GetArea() const { return 0; }
+};
+
+// #2. 소멸자를 호출하지 않아도 되는 타입 입니다.
+template<typename T>
+struct IsTriviallyReleasable : std::is_trivially_destructible<T> {};
+
+// #3. 멤버를 추가하지 않은 Shape 의 자식 클래스만 지정할수 있습니다.
+template<typename T>
+struct ReleasableShape : std::true_type {
+    static_assert(std::is_base_of<Shape, T>::value, "T must derive from Shape");
+    static_assert(std::is_trivially_destructible<Shape::Data>::value, "Shape::Data must be trivially destructible");
+    static_assert(sizeof(Shape) == sizeof(void*) + sizeof(Shape::Data), "Shape must keep its members in Shape::Data");
+    static_assert(sizeof(T) == sizeof(Shape), "T must not add members to Shape");
+};
+template<> struct IsTriviallyReleasable<Rectangle> : ReleasableShape<Rectangle> {};
+template<> struct IsTriviallyReleasable<Ellipse> : ReleasableShape<Ellipse> {};
+template<> struct IsTriviallyReleasable<Triangle> : ReleasableShape<Triangle> {};
+
+// #1.
+template<typename Resource>
+class FrameScope {
+    struct Destructor {
+        void* m_Ptr;
+        void (*m_Destroy)(void*);
+    };
+    Resource& m_Resource;
+    std::pmr::vector<Destructor> m_Destructors; // 소멸자를 호출해야 하는 개체들. 같은 리소스에 할당합니다.
+
+    template<typename T>
+    static void Destroy(void* ptr) { static_cast<T*>(ptr)->~T(); }
+public:
+    explicit FrameScope(Resource& resource) : 
+        m_Resource(resource), 
+        m_Destructors(&resource) {}
+    ~FrameScope() { Release(); }
+    FrameScope(const FrameScope&) = delete;
+    FrameScope& operator =(const FrameScope&) = delete;
+
+    template<typename T, typename... Args>
+    T* New(Args&&... args) {
+        T* result = new (m_Resource.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!IsTriviallyReleasable<T>::value) { // #2
+            Destructor destructor = { result, &Destroy<T> };
+            m_Destructors.push_back(destructor);
+        }
+        return result;
+    }
+    // #2. 기록된 소멸자만 역순으로 호출하고, 메모리를 한번에 해제합니다.
+    void Release() {
+        for (std::size_t i = m_Destructors.size(); i > 0; --i) {
+            m_Destructors[i - 1].m_Destroy(m_Destructors[i - 1].m_Ptr);
+        }
+        m_Destructors = std::pmr::vector<Destructor>(&m_Resource); // 리소스를 해제하기 전에 버립니다.
+        m_Resource.release();
+    }
+    std::size_t GetDestructorCount() const { return m_Destructors.size(); }
+};
+
+{
+    std::pmr::monotonic_buffer_resource resource;
+    FrameScope<std::pmr::monotonic_buffer_resource> frame(resource);
+    Shape* shapes[3] = {
+        frame.New<Rectangle>(0, 0, 10, 20),
+        frame.New<Ellipse>(0, 0, 10, 20),
+        frame.New<Label>(0, 0, "a long text that does not fit in the small string buffer")
+    };
+    EXPECT_TRUE(shapes[0]->GetArea() == 200);
+    EXPECT_TRUE(frame.GetDestructorCount() == 1); // (0) Label 만 소멸자를 호출합니다.
+
+    frame.Release(); // (0) Label 소멸 후 한번에 해제합니다. delete shapes[i] 를 하면 안됩니다.
+}
+
+/*      프레임 단위 할당 측정 - new/delete 와 비교      */
+// 도형 10^6 개를 만들고 모두 소멸하는 것을 프레임마다 반복하여 1 프레임의 시간을 비교합니다.
+//  1. new 와 Shape* 로 다형 소멸 (delete)
+//  2. unsynchronized_pool_resource, 소멸자 생략
+//  3. monotonic_buffer_resource, 소멸자 생략
+//  4. 미리 할당한 버퍼를 사용하는 monotonic_buffer_resource, 소멸자 생략
+#include <chrono>
+#include <vector>
+
+template<typename Func>
+double MeasureFrameMs(int frameCount, Func func) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; ++frame) func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / frameCount;
+}
+
+template<typename NewFunc>
+long long BuildScene(std::vector<Shape*>& shapes, int count, NewFunc newFunc) {
+    long long area = 0;
+    shapes.clear();
+    for (int i = 0; i < count; ++i) {
+        switch (i % 3) {
+        case 0: shapes.push_back(newFunc(static_cast<Rectangle*>(NULL), i)); break;
+        case 1: shapes.push_back(newFunc(static_cast<Ellipse*>(NULL), i)); break;
+        default: shapes.push_back(newFunc(static_cast<Triangle*>(NULL), i)); break;
+        }
+        area += shapes.back()->GetArea();
+    }
+    return area;
+}
+
+const int count = 1000000;
+const int frameCount = 10;
+std::vector<Shape*> shapes;
+shapes.reserve(count);
+
+double newMs = MeasureFrameMs(frameCount, [&]() {
+    BuildScene(shapes, count, [](auto* type, int i) -> Shape* { 
+        return new typename std::remove_pointer<decltype(type)>::type(i, i, 10, 20); 
+    });
+    for (Shape* shape : shapes) delete shape; // 다형 소멸
+});
+
+std::pmr::unsynchronized_pool_resource poolResource;
+double poolMs = MeasureFrameMs(frameCount, [&]() {
+    FrameScope<std::pmr::unsynchronized_pool_resource> frame(poolResource);
+    BuildScene(shapes, count, [&](auto* type, int i) -> Shape* { 
+        return frame.template New<typename std::remove_pointer<decltype(type)>::type>(i, i, 10, 20); 
+    });
+}); // frame 소멸시 한번에 해제
+
+std::pmr::monotonic_buffer_resource monotonicResource;
+double monotonicMs = MeasureFrameMs(frameCount, [&]() {
+    FrameScope<std::pmr::monotonic_buffer_resource> frame(monotonicResource);
+    BuildScene(shapes, count, [&](auto* type, int i) -> Shape* { 
+        return frame.template New<typename std::remove_pointer<decltype(type)>::type>(i, i, 10, 20); 
+    });
+});
+
+// #5. 도형당 24byte + 여유
+std::vector<std::byte> buffer(static_cast<std::size_t>(count) * 32);
+std::pmr::monotonic_buffer_resource bufferResource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+double bufferMs = MeasureFrameMs(frameCount, [&]() {
+    FrameScope<std::pmr::monotonic_buffer_resource> frame(bufferResource);
+    BuildScene(shapes, count, [&](auto* type, int i) -> Shape* { 
+        return frame.template New<typename std::remove_pointer<decltype(type)>::type>(i, i, 10, 20); 
+    });
+});
+
+std::cout << "frame ms - new/delete: " << newMs << " pool: " << poolMs 
+    << " monotonic: " << monotonicMs << " monotonic + buffer: " << bufferMs << std::endl;
+// new/delete 는 도형마다 할당, 가상 소멸자 호출, 해제를 합니다. FrameScope 는 할당이 
+//  포인터 증가 (monotonic) 또는 free list 에서 꺼내기 (pool) 이고, 소멸자 호출 없이 
+//  release() 한번으로 끝납니다. null_memory_resource 를 upstream 으로 주면 버퍼가 부족할때 
+//  std::bad_alloc 이 발생하므로, 최대 도형 수에 맞게 버퍼 크기를 정하세요.
@@ -176,6 +176,7 @@ public:
 
 // 복사 생성시 m_Ptr을 복제하고, 소멸시 delete 합니다.
 // 복사 대입 연산은 임시 개체 생성 후 swap 합니다.
+// 복사는 잦고 수정은 드물다면 CowIntPtr 로 대체할수 있습니다. (Copy-on-Write 스마트 포인터 참고)
 class IntPtr {
 private:
     int* m_Ptr;
@@ -254,6 +255,49 @@ int T::GetVal1() const { return *(m_Impl->m_Val1); }
 int T::GetVal2() const { return *(m_Impl->m_Val2); }
 // STL을 이용하면 좀더 간단하게 구현할수 있습니다. 자세한 내용은 "unique_ptr을 이용한 PImpl 구현"을 참고
 
+/*  ClonePtr 을 이용한 PImpl 이디엄 구현    */
+/*
+ImplPtr, IntPtr 은 타입만 다를 뿐 동일한 스마트 포인터이므로, 일반화된 ClonePtr 로 
+    대체할수 있습니다. (ClonePtr - 깊은 복제를 하는 일반화된 스마트 포인터 참고)
+    앞의 ImplPtr 구현은 PImpl 의 원리 설명을 위해 그대로 두고, 여기서 ClonePtr 로 
+    다시 작성합니다.
+    1. ClonePtr 은 복제/이동/소멸 방법을 생성 시점에 정하므로, 선언부에서 Impl 을 
+        전방 선언만 해도 됩니다.
+    2. 이동 생성자, 이동 대입 연산자가 noexcept 여서 std::vector 재할당시 복제하지 않습니다.
+    3. Impl 의 멤버인 int 들은 ClonePtr<int> 의 m_Buffer 에 생성되어 힙 할당이 없습니다.
+*/
+// ----
+// 선언에서
+// ----
+class T {
+    class Impl; // 전방 선언
+    ClonePtr<Impl> m_Impl; // #1. ImplPtr 선언이 필요 없습니다.
+public:
+    T(int val1, int val2);
+
+    int GetVal1() const;
+    int GetVal2() const;
+};
+
+// ----
+// 정의에서
+// ----
+class T::Impl {
+public:
+    ClonePtr<int> m_Val1; // #3
+    ClonePtr<int> m_Val2; // #3
+    Impl(int val1, int val2) :
+        m_Val1(ClonePtr<int>::Make(val1)),
+        m_Val2(ClonePtr<int>::Make(val2)) {}
+};
+
+// Impl 은 m_Buffer 보다 크므로 힙에 생성됩니다.
+T::T(int val1, int val2) :
+    m_Impl(ClonePtr<T::Impl>::Make(val1, val2)) {}
+
+int T::GetVal1() const { return *(m_Impl->m_Val1); }
+int T::GetVal2() const { return *(m_Impl->m_Val2); }
+
 /*  PImpl 이디엄 오버헤드   */
 /*
 PImpl 이디엄은
@@ -263,4 +307,319 @@ PImpl 이디엄은
     1. 멤버 변수 접근 오버헤드 : m_Impl 을 통해 간접적으로 접근합니다.
     2. 메모리 골간 오버헤드 : m_Impl 포인터 메모리 공간이 추가로 필요합니다.
     3. 힙 공간 오버해드 : m_Impl 과 멤버 변수들이 모두 힙 공간에만 배치됩니다.
-*/
\ No newline at end of file
+*/
+/*  Fast PImpl - 힙을 사용하지 않는 PImpl 이디엄    */
+/*
+PImpl 이디엄 오버헤드 중 힙 공간 오버헤드와 m_Impl 포인터 공간 오버헤드는, Impl 을
+    힙 대신 T 내부의 바이트 버퍼에 생성하여 없앨 수 있습니다.
+
+선언부에서는,
+    1. Impl 은 여전히 전방 선언만 합니다.
+    2. Impl 의 크기와 정렬을 상수로만 공개하고, 그 크기만큼 정렬된 바이트 버퍼를 
+        멤버 변수로 둡니다. 구현 상세는 여전히 은닉됩니다.
+    3. 버퍼에 직접 생성/소멸하므로 복사 생성자, 소멸자, 복사 대입 연산자, Swap을 
+        구현해야 합니다.
+정의부에서는,
+    4. static_assert 로 Impl 이 버퍼에 들어가는지 컴파일 타임에 검사합니다. (C++11~)
+        Impl 이 바뀌었는데 선언부의 상수를 고치지 않았다면 컴파일 오류가 납니다.
+    5. 위치 지정 new 로 버퍼에 Impl 을 생성하고, 소멸자를 직접 호출합니다.
+    6. Impl 에 IntPtr 을 두면 다시 힙을 사용하므로, 값 타입 멤버 변수를 사용합니다.
+
+(~) 주의. Impl 의 크기가 선언부에 노출되므로, Impl 의 크기가 바뀌면 T를 사용하는 
+    코드를 모두 다시 컴파일해야 합니다. 컴파일 종속성 최소화라는 PImpl 의 장점 일부를 
+    포기하고 속도를 얻는 것이니, 측정후 필요할 때만 사용하세요.
+*/
+#include <cstddef>
+#include <new>
+
+// ----
+// 선언에서
+// ----
+class T {
+    class Impl; // #1
+    static const std::size_t ImplSize = 8;  // #2. Impl 의 크기와 정렬만 공개합니다.
+    static const std::size_t ImplAlign = 4;
+    alignas(ImplAlign) unsigned char m_Storage[ImplSize]; // #2. m_Impl 포인터 대신 버퍼를 둡니다.
+
+    Impl& GetImpl();
+    const Impl& GetImpl() const;
+public:
+    T(int val1, int val2);
+    T(const T& other);  // #3
+    ~T();
+    T& operator =(const T& other);
+    void Swap(T& other);
+
+    int GetVal1() const;
+    int GetVal2() const;
+};
+
+// ----
+// 정의에서
+// ----
+class T::Impl {
+public:
+    int m_Val1; // #6. 힙을 사용하지 않도록 값 타입입니다.
+    int m_Val2;
+    Impl(int val1, int val2) :
+        m_Val1(val1),
+        m_Val2(val2) {}
+};
+
+// C++17~: 버퍼에 생성된 개체는 std::launder 를 거쳐 접근합니다.
+T::Impl& T::GetImpl() { return *std::launder(reinterpret_cast<Impl*>(m_Storage)); }
+const T::Impl& T::GetImpl() const { return *std::launder(reinterpret_cast<const Impl*>(m_Storage)); }
+
+// #5. 힙 대신 m_Storage 에 생성합니다.
+T::T(int val1, int val2) {
+    // #4. 버퍼 크기나 정렬이 부족하면 컴파일 오류입니다. ImplSize 등은 private 이라 멤버 함수에서 검사합니다.
+    static_assert(sizeof(Impl) <= ImplSize, "T::ImplSize is too small for T::Impl");
+    static_assert(alignof(Impl) <= ImplAlign, "T::ImplAlign is too small for T::Impl");
+    // (△) 버퍼가 너무 크면 공간 낭비이니 크기가 같은지도 검사하는게 좋습니다.
+    static_assert(sizeof(Impl) == ImplSize, "T::ImplSize wastes space. Update it to sizeof(T::Impl)");
+
+    new(m_Storage) Impl(val1, val2);
+}
+T::T(const T& other) { new(m_Storage) Impl(other.GetImpl()); } // Impl 의 복사 생성자를 호출합니다.
+T::~T() { GetImpl().~Impl(); } // #5. delete 가 아니라 소멸자만 호출합니다.
+
+T& T::operator =(const T& other) {
+    T temp(other);  // (0) 스택에 생성되므로 힙 할당이 없습니다.
+    Swap(temp);
+    return *this;
+}
+void T::Swap(T& other) {
+    // 포인터가 아니라 Impl 을 바꿔치기 합니다. int 끼리여서 예외가 발생하지 않습니다.
+    std::swap(GetImpl().m_Val1, other.GetImpl().m_Val1);
+    std::swap(GetImpl().m_Val2, other.GetImpl().m_Val2);
+}
+
+// (0) m_Impl 포인터를 따라가지 않고 개체 내부에서 바로 읽습니다.
+int T::GetVal1() const { return GetImpl().m_Val1; }
+int T::GetVal2() const { return GetImpl().m_Val2; }
+
+{
+    T t1(10, 20);   // (0) 힙 할당이 없습니다.
+    T t2(t1);       // (0) 힙 할당이 없습니다.
+    EXPECT_TRUE(t2.GetVal1() == 10 && t2.GetVal2() == 20);
+
+    T t3(1, 2);
+    t3 = t1;        // (0) 힙 할당이 없습니다.
+    EXPECT_TRUE(t3.GetVal1() == 10 && t3.GetVal2() == 20);
+    EXPECT_TRUE(sizeof(T) == 8); // m_Impl 포인터 없이 Impl 크기 그대로 입니다.
+}
+
+/*  ImplPtr PImpl 과 Fast PImpl 측정    */
+// 복사 대입 연산자까지 지원하는 스마트 포인터에서 정의한 g_AllocCount, Measure() 를 
+//  사용합니다. (깊은 복제와 Copy-on-Write 측정 참고)
+// ImplPtrT 는 스마트 포인터를 이용한 PImpl 이디엄 구현의 T, FastT 는 상기 T 입니다.
+const int count = 1000000;
+ImplPtrT implSrc(new int(10), new int(20));
+FastT fastSrc(10, 20);
+int sum = 0; // 최적화로 루프가 제거되지 않도록 결과를 사용합니다.
+
+Measure("ImplPtrT construct", count, [&](int i) { ImplPtrT t(new int(i), new int(i)); sum += t.GetVal1(); });   // 4회 할당
+Measure("FastT construct", count, [&](int i) { FastT t(i, i); sum += t.GetVal1(); });                           // 할당 없음
+Measure("ImplPtrT copy", count, [&](int) { ImplPtrT t(implSrc); sum += t.GetVal1(); });                         // 3회 할당
+Measure("FastT copy", count, [&](int) { FastT t(fastSrc); sum += t.GetVal1(); });                               // 할당 없음
+Measure("ImplPtrT GetVal", count, [&](int) { sum += implSrc.GetVal1() + implSrc.GetVal2(); });  // m_Impl, m_Ptr 두번 따라감
+Measure("FastT GetVal", count, [&](int) { sum += fastSrc.GetVal1() + fastSrc.GetVal2(); });     // 개체 내부에서 읽음
+// GetVal1()/GetVal2() 는 정의부에 있어 인라인되지 않으므로, 함수 호출 비용은 둘다 같습니다.
+//  차이는 포인터를 따라가는 간접 참조와 캐시 미스입니다.
+
+/*  쓰레드별 메모리 풀을 이용한 T::Impl 할당   */
+/*
+Fast PImpl 처럼 Impl 크기를 선언부에 노출하고 싶지 않다면, Impl 은 힙에 두되 
+    malloc 대신 메모리 풀에서 할당할수 있습니다. T::T(int*, int*)의 new T::Impl 과 
+    ImplPtr 복사 생성자의 new T::Impl(*other.m_Ptr)는 모두 T::Impl::operator new 를 
+    호출하므로, Impl 에 클래스 operator new/delete 만 추가하면 됩니다.
+
+PoolAllocator<Size> 는,
+    1. 같은 크기의 블럭만 관리하므로 반납된 블럭을 단방향 리스트(free list)로 연결해 
+        두었다가 재사용합니다.
+    2. 쓰레드마다 자신의 free list 를 가지므로 (thread_local, C++11~) 할당/반납시 
+        잠금이 없습니다.
+    3. 다른 쓰레드가 할당한 블럭을 반납해도 자신의 free list 에 넣습니다. 생산자 쓰레드가 
+        할당하고 소비자 쓰레드가 반납하면 소비자 쪽에만 쌓이므로, MaxLocal 을 넘으면 
+        BatchSize 만큼 공용 Depot 으로 넘기고, 할당할 블럭이 없는 쓰레드는 Depot 에서 
+        가져갑니다. Depot 만 mutex 로 보호합니다.
+    4. 쓰레드별로 풀 적중(hit), 실패(miss) 횟수와 보관중인 바이트를 셉니다. 
+        쓰레드 내부 변수라 atomic 연산이 필요 없습니다.
+    5. 쓰레드가 종료되면 보관중인 블럭을 Depot 으로 넘깁니다.
+*/
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// 쓰레드별 카운터 입니다.
+struct PoolStats {
+    long long m_Hits;       // 쓰레드 free list 나 Depot 에서 할당한 횟수
+    long long m_Misses;     // ::operator new 로 할당한 횟수
+    std::size_t m_BytesHeld; // 쓰레드 free list 에 보관중인 바이트
+};
+
+template<std::size_t Size>
+class PoolAllocator {
+private:
+    struct Node { Node* m_Next; }; // #1. 반납된 블럭의 앞부분을 링크로 사용합니다.
+
+    static const std::size_t BlockSize = Size < sizeof(Node) ? sizeof(Node) : Size;
+    static const std::size_t MaxLocal = 256;   // #3. 쓰레드 free list 최대 개수
+    static const std::size_t BatchSize = 128;  // #3. Depot 과 주고받는 개수
+
+    // 블럭들을 단방향 리스트로 보관합니다.
+    struct FreeList {
+        Node* m_Head;
+        std::size_t m_Count;
+        FreeList() : m_Head(nullptr), m_Count(0) {}
+
+        void Push(Node* node) { node->m_Next = m_Head; m_Head = node; ++m_Count; }
+        Node* Pop() { Node* node = m_Head; m_Head = node->m_Next; --m_Count; return node; }
+        // 앞쪽 count 개를 떼어 other 앞에 붙입니다.
+        void MoveTo(FreeList& other, std::size_t count) {
+            while (count-- != 0 && m_Head != nullptr) other.Push(Pop());
+        }
+    };
+
+    // #3. 쓰레드간 블럭을 주고받는 공용 보관소 입니다.
+    struct Depot {
+        std::mutex m_Mutex;
+        FreeList m_List;
+        ~Depot() { // 프로그램 종료시 메모리를 해제합니다.
+            while (m_List.m_Head != nullptr) ::operator delete(m_List.Pop());
+        }
+    };
+    static Depot& GetDepot() {
+        static Depot depot; // C++11~: 함수내 정적 지역 변수는 쓰레드에 안전하게 초기화됩니다.
+        return depot;
+    }
+
+    // #2. 쓰레드별 free list 와 카운터 입니다.
+    struct LocalCache {
+        FreeList m_List;
+        PoolStats m_Stats;
+        LocalCache() { m_Stats.m_Hits = 0; m_Stats.m_Misses = 0; m_Stats.m_BytesHeld = 0; }
+        ~LocalCache() { // #5.
+            Depot& depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.m_Mutex);
+            m_List.MoveTo(depot.m_List, m_List.m_Count);
+        }
+    };
+    static LocalCache& GetLocal() {
+        thread_local LocalCache cache;
+        return cache;
+    }
+public:
+    static void* Allocate(std::size_t size) {
+        if (size != Size) return ::operator new(size); // 자식 클래스등 크기가 다르면 풀을 사용하지 않습니다.
+
+        LocalCache& local = GetLocal();
+        if (local.m_List.m_Head == nullptr) {
+            // #3. 다른 쓰레드에서 반납한 블럭이 있다면 가져옵니다.
+            Depot& depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.m_Mutex);
+            std::size_t before = local.m_List.m_Count;
+            depot.m_List.MoveTo(local.m_List, BatchSize);
+            local.m_Stats.m_BytesHeld += (local.m_List.m_Count - before) * BlockSize; // Depot 에 BatchSize 보다 적게 있을 수 있습니다.
+        }
+        if (local.m_List.m_Head == nullptr) {
+            ++local.m_Stats.m_Misses;
+            return ::operator new(BlockSize); // 예외는 그대로 전파합니다.
+        }
+        ++local.m_Stats.m_Hits;
+        local.m_Stats.m_BytesHeld -= BlockSize;
+        return local.m_List.Pop();
+    }
+    static void Deallocate(void* p, std::size_t size) noexcept {
+        if (p == nullptr) return;
+        if (size != Size) { ::operator delete(p); return; }
+
+        LocalCache& local = GetLocal();
+        local.m_List.Push(static_cast<Node*>(p));
+        local.m_Stats.m_BytesHeld += BlockSize;
+
+        if (local.m_List.m_Count > MaxLocal) {
+            // #3. 너무 많이 쌓였다면 Depot 으로 넘깁니다.
+            Depot& depot = GetDepot();
+            std::lock_guard<std::mutex> lock(depot.m_Mutex);
+            local.m_List.MoveTo(depot.m_List, BatchSize);
+            local.m_Stats.m_BytesHeld -= BatchSize * BlockSize;
+        }
+    }
+    // #4. 호출한 쓰레드의 카운터 입니다.
+    static PoolStats GetThreadStats() { return GetLocal().m_Stats; }
+    // Depot 에 보관중인 바이트 입니다.
+    static std::size_t GetDepotBytes() {
+        Depot& depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.m_Mutex);
+        return depot.m_List.m_Count * BlockSize;
+    }
+};
+
+// ----
+// Impl 정의
+// ----
+class T::Impl {
+public:
+    IntPtr m_Val1;
+    IntPtr m_Val2;
+    Impl(int* val1, int* val2) : 
+        m_Val1(val1),
+        m_Val2(val2) {}
+
+    // (0) new T::Impl, delete m_Ptr 이 PoolAllocator 를 사용합니다.
+    static void* operator new(std::size_t size) { return PoolAllocator<sizeof(Impl)>::Allocate(size); }
+    static void operator delete(void* p, std::size_t size) noexcept { PoolAllocator<sizeof(Impl)>::Deallocate(p, size); }
+private:
+    Impl& operator =(const Impl& other) { return *this; }
+};
+// ImplPtr, T 정의는 스마트 포인터를 이용한 PImpl 이디엄 구현과 동일합니다.
+// (~) IntPtr 의 new int 는 int 에 클래스 operator new 를 둘수 없어 여전히 malloc 을 사용합니다.
+//  이것까지 없애려면 Impl 에 int 를 값으로 두세요. (Fast PImpl 참고)
+
+{
+    T t1(new int(10), new int(20));  // (~) 첫 할당은 free list 가 비어 있어 miss 입니다.
+    {
+        T t2(t1);   // (~) miss
+    }               // t2 의 Impl 이 free list 로 반납됩니다.
+    T t3(t1);       // (0) 반납된 블럭을 재사용합니다. hit
+
+    PoolStats stats = PoolAllocator<sizeof(T::Impl)>::GetThreadStats(); // 실제로는 Impl 이 private 이므로 T 내부에서 조회합니다.
+    EXPECT_TRUE(stats.m_Misses == 2 && stats.m_Hits == 1 && stats.m_BytesHeld == 0);
+}
+{
+    // 다른 쓰레드가 반납해서 Depot 으로 넘어간 블럭을 할당하는 경우 입니다.
+    // T::Impl 의 카운터와 섞이지 않도록 다른 크기의 PoolAllocator 를 사용합니다.
+    typedef PoolAllocator<64> Pool;
+    std::thread freer([]() {
+        void* blocks[300];
+        for (int i = 0; i < 300; ++i) blocks[i] = Pool::Allocate(64);
+        for (int i = 0; i < 300; ++i) Pool::Deallocate(blocks[i], 64); // 257 번째 반납시 128개를 Depot 으로 넘깁니다.
+    });             // #5. 종료시 남은 172개도 Depot 으로 넘깁니다.
+    freer.join();
+    EXPECT_TRUE(Pool::GetDepotBytes() == 300 * 64);
+
+    PoolStats stats;
+    std::thread allocator([&stats]() {
+        void* block = Pool::Allocate(64); // (0) Depot 에서 128개를 가져와 1개를 사용합니다. hit
+        stats = Pool::GetThreadStats();
+        Pool::Deallocate(block, 64);
+    });
+    allocator.join();
+    EXPECT_TRUE(stats.m_Misses == 0 && stats.m_Hits == 1 && stats.m_BytesHeld == 127 * 64); // (0) 가져온 블럭을 보관중인 바이트에 더합니다.
+}
+
+/*  malloc 과 PoolAllocator 측정    */
+// 깊은 복제와 Copy-on-Write 측정의 g_AllocCount, Measure() 를 사용합니다.
+// MallocT 는 클래스 operator new 가 없는 Impl 을, PoolT 는 상기 Impl 을 사용하는 T 입니다.
+const int count = 1000000;
+MallocT mallocSrc(new int(10), new int(20));
+PoolT poolSrc(new int(10), new int(20));
+int sum = 0;
+
+Measure("MallocT copy/destroy", count, [&](int) { MallocT t(mallocSrc); sum += t.GetVal1(); });
+Measure("PoolT copy/destroy", count, [&](int) { PoolT t(poolSrc); sum += t.GetVal1(); });   // Impl 할당이 allocs/op 에서 빠집니다.
+
+// 생산자/소비자 쓰레드: 생산자가 만든 T 를 소비자가 소멸시키면, 블럭은 Depot 을 거쳐 생산자에게 돌아갑니다.
+// 측정 후 각 쓰레드의 GetThreadStats() 로 hit 비율을 확인하세요.
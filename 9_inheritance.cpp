@@ -764,4 +764,1699 @@ Ellipse ellipse;
 Shape* shape = &rect1;
 
 rect1 = rect2;      // (0) 메시지 표시 안됨
-*shape = rect2;     // (x) 복사 대입 연산은 protected 임
\ No newline at end of file
+*shape = rect2;     // (x) 복사 대입 연산은 protected 임
+
+/*      공간 인덱스 - 도형 영역으로 빠르게 찾기      */
+/*
+도형들은 위치와 크기를 가집니다. (Shape 의 m_Left/m_Top/m_Width/m_Height, 
+    ResizeableImpl 의 너비/높이) 어떤 점을 덮는 도형이나 어떤 영역과 겹치는 도형을 찾으려면 
+    지금은 Shape* 를 모두 순회할수 밖에 없습니다. 도형이 많고 질의가 잦다면 공간 인덱스를 
+    사용합니다.
+
+    1. Box 는 도형의 경계 영역입니다. (m_Right, m_Bottom 은 포함하지 않습니다.)
+    2. ISpatialIndex 는 점 질의 (QueryPoint), 영역 질의 (QueryBox), 가까운 k 개 질의 
+        (QueryNearest) 와 갱신 (Update) 을 제공합니다.
+    3. PackedRTree 는 모든 도형을 한번에 넣어 만드는 (bulk load) R-tree 입니다. 
+        중심의 x 로 정렬해 세로 띠로 나누고, 띠마다 y 로 정렬해 NodeSize 개씩 묶는 
+        STR (Sort-Tile-Recursive) 방식으로 잎 노드를 만들고, 위로 NodeSize 개씩 묶어 
+        올라갑니다. 노드들은 배열 하나에 연속으로 저장됩니다.
+        Update() 는 잎의 Box 를 바꾸고 부모 노드들의 Box 를 다시 계산합니다. 갱신이 많이 
+        쌓이면 노드 Box 가 커져 질의가 느려지므로, 그때는 다시 Build() 하세요.
+    4. UniformGrid 는 화면을 같은 크기의 칸으로 나누고, 칸마다 겹치는 도형 목록을 가집니다.
+        도형 크기가 비슷하고 갱신이 잦을때 유리합니다. Update() 는 이전 칸에서 빼고 새 칸에 
+        넣습니다.
+    5. ResizeableImpl 은 IBoundsListener (단위 전략 인터페이스) 를 통해 SetWidth()/SetHeight()
+        로 크기가 바뀔때마다 이전/새 Box 를 알립니다. 공간 인덱스가 IBoundsListener 를 
+        구현하므로 자동으로 갱신됩니다.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+// #1.
+struct Box {
+    int m_Left;
+    int m_Top;
+    int m_Right;
+    int m_Bottom;
+
+    bool Intersects(const Box& other) const {
+        return m_Left < other.m_Right && other.m_Left < m_Right && 
+            m_Top < other.m_Bottom && other.m_Top < m_Bottom;
+    }
+    bool Contains(int x, int y) const {
+        return m_Left <= x && x < m_Right && m_Top <= y && y < m_Bottom;
+    }
+    void Merge(const Box& other) {
+        m_Left = std::min(m_Left, other.m_Left);
+        m_Top = std::min(m_Top, other.m_Top);
+        m_Right = std::max(m_Right, other.m_Right);
+        m_Bottom = std::max(m_Bottom, other.m_Bottom);
+    }
+    // (x, y) 픽셀에서 Box 에 포함된 가장 가까운 픽셀까지 거리의 제곱 입니다.
+    std::int64_t DistanceSquared(int x, int y) const {
+        std::int64_t dx = x < m_Left ? m_Left - x : (x >= m_Right ? x - (m_Right - 1) : 0);
+        std::int64_t dy = y < m_Top ? m_Top - y : (y >= m_Bottom ? y - (m_Bottom - 1) : 0);
+        return dx * dx + dy * dy;
+    }
+    bool operator ==(const Box& other) const {
+        return m_Left == other.m_Left && m_Top == other.m_Top && m_Right == other.m_Right && m_Bottom == other.m_Bottom;
+    }
+};
+
+// #5. 크기 변경을 알리는 단위 전략 인터페이스 입니다.
+class IBoundsListener {
+protected:
+    ~IBoundsListener() {} // 인터페이스여서 protected non-virtual 입니다.
+public:
+    virtual void OnBoundsChanged(std::uint32_t id, const Box& oldBox, const Box& newBox) = 0;
+};
+
+// #2.
+class ISpatialIndex : public IBoundsListener {
+protected:
+    ~ISpatialIndex() {}
+public:
+    virtual void Build(const std::vector<Box>& boxes) = 0; // id 는 boxes 의 인덱스 입니다.
+    virtual void Update(std::uint32_t id, const Box& newBox) = 0;
+    virtual void QueryBox(const Box& box, std::vector<std::uint32_t>& result) const = 0;
+    virtual void QueryPoint(int x, int y, std::vector<std::uint32_t>& result) const = 0;
+    // 가까운 순서대로 최대 k 개를 찾습니다.
+    virtual void QueryNearest(int x, int y, std::size_t k, std::vector<std::uint32_t>& result) const = 0;
+
+    virtual void OnBoundsChanged(std::uint32_t id, const Box& /*oldBox*/, const Box& newBox) { Update(id, newBox); }
+};
+
+// #3.
+class PackedRTree : public ISpatialIndex {
+    static constexpr std::uint32_t NodeSize = 16;
+    static constexpr std::uint32_t None = 0xFFFFFFFF;
+
+    struct Node {
+        Box m_Box;
+        std::uint32_t m_First;  // 잎이면 m_Entries 의 인덱스, 아니면 m_Nodes 의 인덱스
+        std::uint32_t m_Count;
+        std::uint32_t m_Parent;
+        bool m_IsLeaf;
+    };
+    std::vector<Box> m_Boxes;               // id 별 Box
+    std::vector<std::uint32_t> m_Entries;   // 잎 노드 순서대로 정렬된 id
+    std::vector<std::uint32_t> m_LeafOf;    // id 별 잎 노드 인덱스
+    std::vector<Node> m_Nodes;              // 잎 노드부터 루트까지. 루트는 마지막 입니다.
+
+    static int CenterX(const Box& box) { return box.m_Left + (box.m_Right - box.m_Left) / 2; }
+    static int CenterY(const Box& box) { return box.m_Top + (box.m_Bottom - box.m_Top) / 2; }
+
+    void RefitNode(Node& node) {
+        bool first = true;
+        for (std::uint32_t i = 0; i < node.m_Count; ++i) {
+            const Box& child = node.m_IsLeaf ? m_Boxes[m_Entries[node.m_First + i]] : m_Nodes[node.m_First + i].m_Box;
+            if (first) { node.m_Box = child; first = false; }
+            else node.m_Box.Merge(child);
+        }
+    }
+    // [first, first + count) 의 노드/엔트리를 NodeSize 개씩 묶어 상위 노드를 추가합니다.
+    void AddLevel(std::uint32_t first, std::uint32_t count, bool isLeaf) {
+        for (std::uint32_t i = 0; i < count; i += NodeSize) {
+            Node node;
+            node.m_First = first + i;
+            node.m_Count = std::min(NodeSize, count - i);
+            node.m_Parent = None;
+            node.m_IsLeaf = isLeaf;
+            const std::uint32_t index = static_cast<std::uint32_t>(m_Nodes.size());
+            for (std::uint32_t j = 0; j < node.m_Count; ++j) {
+                if (isLeaf) m_LeafOf[m_Entries[node.m_First + j]] = index;
+                else m_Nodes[node.m_First + j].m_Parent = index;
+            }
+            m_Nodes.push_back(node);
+            RefitNode(m_Nodes.back());
+        }
+    }
+public:
+    virtual void Build(const std::vector<Box>& boxes) {
+        m_Boxes = boxes;
+        m_LeafOf.assign(boxes.size(), None);
+        m_Nodes.clear();
+        m_Entries.resize(boxes.size());
+        for (std::uint32_t i = 0; i < m_Entries.size(); ++i) m_Entries[i] = i;
+        if (m_Entries.empty()) return;
+
+        // STR : x 로 정렬해 세로 띠로 나누고, 띠마다 y 로 정렬합니다.
+        const std::size_t leafCount = (m_Entries.size() + NodeSize - 1) / NodeSize;
+        const std::size_t sliceCount = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(leafCount))));
+        const std::size_t sliceSize = sliceCount * NodeSize;
+        std::sort(m_Entries.begin(), m_Entries.end(), [this](std::uint32_t a, std::uint32_t b) { 
+            return CenterX(m_Boxes[a]) < CenterX(m_Boxes[b]); 
+        });
+        for (std::size_t i = 0; i < m_Entries.size(); i += sliceSize) {
+            std::vector<std::uint32_t>::iterator end = m_Entries.begin() + std::min(i + sliceSize, m_Entries.size());
+            std::sort(m_Entries.begin() + i, end, [this](std::uint32_t a, std::uint32_t b) { 
+                return CenterY(m_Boxes[a]) < CenterY(m_Boxes[b]); 
+            });
+        }
+
+        // 잎 노드를 만들고, 노드가 1개 남을때까지 위로 묶어 올라갑니다.
+        AddLevel(0, static_cast<std::uint32_t>(m_Entries.size()), true);
+        std::uint32_t levelFirst = 0;
+        std::uint32_t levelCount = static_cast<std::uint32_t>(m_Nodes.size());
+        while (levelCount > 1) {
+            AddLevel(levelFirst, levelCount, false);
+            levelFirst += levelCount;
+            levelCount = static_cast<std::uint32_t>(m_Nodes.size()) - levelFirst;
+        }
+    }
+
+    // #3. 잎부터 루트까지 Box 를 다시 계산합니다. 바뀌지 않으면 중단합니다.
+    virtual void Update(std::uint32_t id, const Box& newBox) {
+        m_Boxes[id] = newBox;
+        for (std::uint32_t index = m_LeafOf[id]; index != None; index = m_Nodes[index].m_Parent) {
+            Box before = m_Nodes[index].m_Box;
+            RefitNode(m_Nodes[index]);
+            if (m_Nodes[index].m_Box == before) break;
+        }
+    }
+
+    virtual void QueryBox(const Box& box, std::vector<std::uint32_t>& result) const {
+        result.clear();
+        if (m_Nodes.empty()) return;
+        std::vector<std::uint32_t> stack(1, static_cast<std::uint32_t>(m_Nodes.size() - 1));
+        while (!stack.empty()) {
+            const Node& node = m_Nodes[stack.back()];
+            stack.pop_back();
+            if (!node.m_Box.Intersects(box)) continue;
+            for (std::uint32_t i = 0; i < node.m_Count; ++i) {
+                if (!node.m_IsLeaf) { stack.push_back(node.m_First + i); continue; }
+                std::uint32_t id = m_Entries[node.m_First + i];
+                if (m_Boxes[id].Intersects(box)) result.push_back(id);
+            }
+        }
+    }
+    virtual void QueryPoint(int x, int y, std::vector<std::uint32_t>& result) const {
+        Box box = { x, y, x + 1, y + 1 };
+        QueryBox(box, result);
+    }
+
+    // 거리가 가까운 노드/도형부터 꺼내는 최선 우선 탐색입니다. 
+    //  도형이 꺼내지면 남은 어떤 것보다 가까우므로 바로 결과에 추가합니다.
+    virtual void QueryNearest(int x, int y, std::size_t k, std::vector<std::uint32_t>& result) const {
+        result.clear();
+        if (m_Nodes.empty()) return;
+        struct Item {
+            std::int64_t m_Distance;
+            std::uint32_t m_Index;
+            bool m_IsEntry; // true 면 m_Index 는 id, false 면 노드 인덱스
+            bool operator <(const Item& other) const { return m_Distance > other.m_Distance; } // 작은게 먼저
+        };
+        std::priority_queue<Item> queue;
+        const std::uint32_t root = static_cast<std::uint32_t>(m_Nodes.size() - 1);
+        Item rootItem = { m_Nodes[root].m_Box.DistanceSquared(x, y), root, false };
+        queue.push(rootItem);
+        while (!queue.empty() && result.size() < k) {
+            Item item = queue.top();
+            queue.pop();
+            if (item.m_IsEntry) { result.push_back(item.m_Index); continue; }
+
+            const Node& node = m_Nodes[item.m_Index];
+            for (std::uint32_t i = 0; i < node.m_Count; ++i) {
+                Item child;
+                child.m_IsEntry = node.m_IsLeaf;
+                child.m_Index = node.m_IsLeaf ? m_Entries[node.m_First + i] : node.m_First + i;
+                child.m_Distance = node.m_IsLeaf ? m_Boxes[child.m_Index].DistanceSquared(x, y) : m_Nodes[child.m_Index].m_Box.DistanceSquared(x, y);
+                queue.push(child);
+            }
+        }
+    }
+};
+
+// #4.
+class UniformGrid : public ISpatialIndex {
+    Box m_World;        // 칸으로 나눌 전체 영역. 밖의 도형은 가장자리 칸에 넣습니다.
+    int m_CellSize;
+    int m_CellsX;
+    int m_CellsY;
+    std::vector<Box> m_Boxes;
+    std::vector<std::vector<std::uint32_t> > m_Cells;
+    mutable std::vector<std::uint32_t> m_Visited;   // 여러 칸에 걸친 도형을 중복 추가하지 않도록 질의 번호를 기록합니다.
+    mutable std::uint32_t m_QueryStamp;
+
+    int CellX(int x) const { return std::min(std::max((x - m_World.m_Left) / m_CellSize, 0), m_CellsX - 1); }
+    int CellY(int y) const { return std::min(std::max((y - m_World.m_Top) / m_CellSize, 0), m_CellsY - 1); }
+
+    template<typename Func>
+    void ForEachCell(const Box& box, Func func) const {
+        for (int cy = CellY(box.m_Top); cy <= CellY(box.m_Bottom - 1); ++cy) {
+            for (int cx = CellX(box.m_Left); cx <= CellX(box.m_Right - 1); ++cx) {
+                func(cy * m_CellsX + cx);
+            }
+        }
+    }
+    void Insert(std::uint32_t id) {
+        if (m_Boxes[id].m_Left >= m_Boxes[id].m_Right || m_Boxes[id].m_Top >= m_Boxes[id].m_Bottom) return; // 크기 0
+        ForEachCell(m_Boxes[id], [this, id](int cell) { m_Cells[cell].push_back(id); });
+    }
+    void Remove(std::uint32_t id) {
+        if (m_Boxes[id].m_Left >= m_Boxes[id].m_Right || m_Boxes[id].m_Top >= m_Boxes[id].m_Bottom) return;
+        ForEachCell(m_Boxes[id], [this, id](int cell) {
+            std::vector<std::uint32_t>& ids = m_Cells[cell];
+            std::vector<std::uint32_t>::iterator itr = std::find(ids.begin(), ids.end(), id);
+            *itr = ids.back(); // 순서는 중요하지 않으므로 마지막 요소로 덮어씁니다.
+            ids.pop_back();
+        });
+    }
+    std::uint32_t NextStamp() const {
+        if (++m_QueryStamp == 0) { // 한바퀴 돌았다면 초기화 합니다.
+            std::fill(m_Visited.begin(), m_Visited.end(), 0);
+            m_QueryStamp = 1;
+        }
+        return m_QueryStamp;
+    }
+public:
+    UniformGrid(const Box& world, int cellSize) :
+        m_World(world),
+        m_CellSize(cellSize),
+        m_CellsX((world.m_Right - world.m_Left + cellSize - 1) / cellSize),
+        m_CellsY((world.m_Bottom - world.m_Top + cellSize - 1) / cellSize),
+        m_Cells(static_cast<std::size_t>(m_CellsX) * m_CellsY),
+        m_QueryStamp(0) {}
+
+    virtual void Build(const std::vector<Box>& boxes) {
+        m_Boxes = boxes;
+        m_Visited.assign(boxes.size(), 0);
+        for (std::size_t i = 0; i < m_Cells.size(); ++i) m_Cells[i].clear();
+        for (std::uint32_t id = 0; id < m_Boxes.size(); ++id) Insert(id);
+    }
+    virtual void Update(std::uint32_t id, const Box& newBox) {
+        Remove(id);
+        m_Boxes[id] = newBox;
+        Insert(id);
+    }
+    virtual void QueryBox(const Box& box, std::vector<std::uint32_t>& result) const {
+        result.clear();
+        const std::uint32_t stamp = NextStamp();
+        ForEachCell(box, [&](int cell) {
+            const std::vector<std::uint32_t>& ids = m_Cells[cell];
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                std::uint32_t id = ids[i];
+                if (m_Visited[id] == stamp) continue;
+                m_Visited[id] = stamp;
+                if (m_Boxes[id].Intersects(box)) result.push_back(id);
+            }
+        });
+    }
+    virtual void QueryPoint(int x, int y, std::vector<std::uint32_t>& result) const {
+        Box box = { x, y, x + 1, y + 1 };
+        QueryBox(box, result);
+    }
+    // (x, y) 칸에서 시작해 정사각형 고리 모양으로 넓혀 가며 찾습니다. 
+    //  다음 고리의 칸에 있는 도형은 적어도 ring * m_CellSize 보다 멀기 때문에, k 번째 후보가 
+    //  그보다 가까우면 중단합니다. (전체 영역 밖의 도형을 가장자리 칸에 넣어도 성립합니다.)
+    virtual void QueryNearest(int x, int y, std::size_t k, std::vector<std::uint32_t>& result) const {
+        result.clear();
+        if (k == 0) return;
+        std::vector<std::pair<std::int64_t, std::uint32_t> > candidates;
+        const std::uint32_t stamp = NextStamp();
+        const int cx = CellX(x), cy = CellY(y);
+        auto visit = [&](int ix, int iy) {
+            if (ix < 0 || iy < 0 || ix >= m_CellsX || iy >= m_CellsY) return;
+            const std::vector<std::uint32_t>& ids = m_Cells[iy * m_CellsX + ix];
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                if (m_Visited[ids[i]] == stamp) continue;
+                m_Visited[ids[i]] = stamp;
+                candidates.push_back(std::make_pair(m_Boxes[ids[i]].DistanceSquared(x, y), ids[i]));
+            }
+        };
+        const int maxRing = std::max(m_CellsX, m_CellsY);
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            // 고리의 위/아래 줄은 전부, 나머지 줄은 양 끝 칸만 방문합니다.
+            for (int ix = cx - ring; ix <= cx + ring; ++ix) {
+                visit(ix, cy - ring);
+                if (ring != 0) visit(ix, cy + ring);
+            }
+            for (int iy = cy - ring + 1; iy <= cy + ring - 1; ++iy) {
+                visit(cx - ring, iy);
+                visit(cx + ring, iy);
+            }
+            if (candidates.size() >= k) {
+                std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+                std::int64_t ringDistance = static_cast<std::int64_t>(ring) * m_CellSize;
+                if (candidates[k - 1].first <= ringDistance * ringDistance) break;
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (std::size_t i = 0; i < candidates.size() && i < k; ++i) result.push_back(candidates[i].second);
+    }
+};
+
+// #5. 크기가 바뀌면 IBoundsListener 로 알립니다.
+class ResizeableImpl {
+private:
+    int m_Width;
+    int m_Height;
+    IBoundsListener* m_Listener;
+    std::uint32_t m_Id;
+protected:
+    ResizeableImpl(int w, int h) :
+        m_Width(w),
+        m_Height(h),
+        m_Listener(NULL),
+        m_Id(0) {}
+    ~ResizeableImpl() {}
+    // 너비/높이와 자식 개체의 위치로 Box 를 계산합니다. (Rectangle 은 왼쪽 상단, Ellipse 는 중심 기준)
+    virtual Box CalcBounds() const = 0;
+public:
+    int GetWidth()  const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+
+    void SetWidth(int val) { 
+        Box oldBox = CalcBounds();
+        m_Width = val; 
+        Notify(oldBox);
+    }
+    void SetHeight(int val) { 
+        Box oldBox = CalcBounds();
+        m_Height = val; 
+        Notify(oldBox);
+    }
+    Box GetBounds() const { return CalcBounds(); }
+
+    // listener 에 id 로 변경을 알립니다. NULL 이면 알리지 않습니다.
+    void SetListener(IBoundsListener* listener, std::uint32_t id) {
+        m_Listener = listener;
+        m_Id = id;
+    }
+private:
+    void Notify(const Box& oldBox) {
+        if (m_Listener != NULL) m_Listener->OnBoundsChanged(m_Id, oldBox, CalcBounds());
+    }
+};
+
+class Rectangle : public ResizeableImpl {
+    int m_Left;
+    int m_Top;
+protected:
+    virtual Box CalcBounds() const {
+        Box box = { m_Left, m_Top, m_Left + GetWidth(), m_Top + GetHeight() };
+        return box;
+    }
+public:
+    Rectangle(int l, int t, int w, int h) :
+        ResizeableImpl(w, h),
+        m_Left(l),
+        m_Top(t) {}
+};
+
+class Ellipse : public ResizeableImpl {
+    int m_CenterX;
+    int m_CenterY;
+protected:
+    virtual Box CalcBounds() const {
+        Box box = { m_CenterX - GetWidth() / 2, m_CenterY - GetHeight() / 2, 0, 0 };
+        box.m_Right = box.m_Left + GetWidth();
+        box.m_Bottom = box.m_Top + GetHeight();
+        return box;
+    }
+public:
+    Ellipse(int centerX, int centerY, int w, int h) :
+        ResizeableImpl(w, h),
+        m_CenterX(centerX),
+        m_CenterY(centerY) {}
+};
+
+{
+    Rectangle r(0, 0, 10, 20);
+    Ellipse e(50, 50, 10, 20);  // Box (45, 40) - (55, 60)
+
+    std::vector<Box> boxes;
+    boxes.push_back(r.GetBounds());
+    boxes.push_back(e.GetBounds());
+
+    PackedRTree tree;
+    tree.Build(boxes);
+    r.SetListener(&tree, 0);
+    e.SetListener(&tree, 1);
+
+    std::vector<std::uint32_t> result;
+    tree.QueryPoint(5, 5, result);
+    EXPECT_TRUE(result.size() == 1 && result[0] == 0);
+
+    r.SetWidth(100);            // (0) tree 가 자동으로 갱신됩니다.
+    tree.QueryPoint(50, 15, result);
+    EXPECT_TRUE(result.size() == 1 && result[0] == 0);
+
+    Box box = { 40, 0, 60, 45 };
+    tree.QueryBox(box, result);
+    EXPECT_TRUE(result.size() == 2);
+
+    tree.QueryNearest(80, 50, 1, result);
+    EXPECT_TRUE(result.size() == 1 && result[0] == 1);
+}
+
+/*      공간 인덱스 측정 - 전체 순회와 비교      */
+// 도형 10^6 개에 대해 점 질의, 영역 질의, 가까운 10개 질의와, 1% 도형의 SetWidth() 갱신을 
+//  전체 순회 (brute force) 와 비교합니다. 결과 id 집합이 같은지도 확인합니다.
+#include <chrono>
+#include <cstdlib>
+
+void QueryBruteForce(const std::vector<Box>& boxes, const Box& box, std::vector<std::uint32_t>& result) {
+    result.clear();
+    for (std::uint32_t id = 0; id < boxes.size(); ++id) {
+        if (boxes[id].Intersects(box)) result.push_back(id);
+    }
+}
+
+template<typename Func>
+double MeasureMs(Func func) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+const int count = 1000000;
+const int queryCount = 1000;
+Box world = { 0, 0, 100000, 100000 };
+std::vector<Box> boxes;
+for (int i = 0; i < count; ++i) {
+    int l = std::rand() % world.m_Right, t = std::rand() % world.m_Bottom;
+    Box box = { l, t, l + 1 + std::rand() % 100, t + 1 + std::rand() % 100 };
+    boxes.push_back(box);
+}
+
+PackedRTree tree;
+UniformGrid grid(world, 128);
+std::cout << "build ms - rtree: " << MeasureMs([&]() { tree.Build(boxes); })
+    << " grid: " << MeasureMs([&]() { grid.Build(boxes); }) << std::endl;
+
+std::vector<Box> queries;
+for (int i = 0; i < queryCount; ++i) {
+    int l = std::rand() % world.m_Right, t = std::rand() % world.m_Bottom;
+    Box box = { l, t, l + 1000, t + 1000 };
+    queries.push_back(box);
+}
+
+std::vector<std::uint32_t> expected, actual;
+for (const Box& query : queries) { // 결과가 같은지 확인합니다.
+    QueryBruteForce(boxes, query, expected);
+    tree.QueryBox(query, actual);
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    EXPECT_TRUE(actual == expected);
+    grid.QueryBox(query, actual);
+    std::sort(actual.begin(), actual.end());
+    EXPECT_TRUE(actual == expected);
+}
+for (int i = 0; i < 10; ++i) { // 가까운 10개는 거리가 같은 도형이 있을 수 있어 거리로 비교합니다.
+    std::vector<std::int64_t> bruteDistances, treeDistances, gridDistances;
+    for (const Box& box : boxes) bruteDistances.push_back(box.DistanceSquared(queries[i].m_Left, queries[i].m_Top));
+    std::sort(bruteDistances.begin(), bruteDistances.end());
+    bruteDistances.resize(10);
+    tree.QueryNearest(queries[i].m_Left, queries[i].m_Top, 10, actual);
+    for (std::uint32_t id : actual) treeDistances.push_back(boxes[id].DistanceSquared(queries[i].m_Left, queries[i].m_Top));
+    grid.QueryNearest(queries[i].m_Left, queries[i].m_Top, 10, actual);
+    for (std::uint32_t id : actual) gridDistances.push_back(boxes[id].DistanceSquared(queries[i].m_Left, queries[i].m_Top));
+    EXPECT_TRUE(treeDistances == bruteDistances && gridDistances == bruteDistances);
+}
+
+std::cout << "QueryBox us/query - brute: " << MeasureMs([&]() { for (const Box& q : queries) QueryBruteForce(boxes, q, expected); }) * 1000 / queryCount
+    << " rtree: " << MeasureMs([&]() { for (const Box& q : queries) tree.QueryBox(q, actual); }) * 1000 / queryCount
+    << " grid: " << MeasureMs([&]() { for (const Box& q : queries) grid.QueryBox(q, actual); }) * 1000 / queryCount << std::endl;
+std::cout << "QueryPoint us/query - rtree: " << MeasureMs([&]() { for (const Box& q : queries) tree.QueryPoint(q.m_Left, q.m_Top, actual); }) * 1000 / queryCount
+    << " grid: " << MeasureMs([&]() { for (const Box& q : queries) grid.QueryPoint(q.m_Left, q.m_Top, actual); }) * 1000 / queryCount << std::endl;
+std::cout << "QueryNearest(10) us/query - rtree: " << MeasureMs([&]() { for (const Box& q : queries) tree.QueryNearest(q.m_Left, q.m_Top, 10, actual); }) * 1000 / queryCount
+    << " grid: " << MeasureMs([&]() { for (const Box& q : queries) grid.QueryNearest(q.m_Left, q.m_Top, 10, actual); }) * 1000 / queryCount << std::endl;
+
+// 1% 도형의 너비를 바꿉니다. (SetWidth() 가 OnBoundsChanged() 로 알리는 것과 같습니다.)
+std::cout << "Update ms (1%) - rtree: " << MeasureMs([&]() {
+        for (int i = 0; i < count / 100; ++i) { Box b = boxes[i * 100]; b.m_Right += 10; tree.Update(i * 100, b); }
+    }) << " grid: " << MeasureMs([&]() {
+        for (int i = 0; i < count / 100; ++i) { Box b = boxes[i * 100]; b.m_Right += 10; grid.Update(i * 100, b); }
+    }) << std::endl;
+// 전체 순회는 질의마다 10^6 개를 모두 검사하지만, 공간 인덱스는 결과 근처만 검사합니다.
+//  R-tree 는 도형 분포가 고르지 않아도 잘 동작하고, grid 는 갱신이 싸지만 칸 크기를 도형 
+//  크기에 맞게 정해야 합니다.
+
+/*      변경된 영역만 다시 그리기 (Dirty Region)      */
+/*
+크기가 바뀐 도형을 모르면 매 프레임마다 모든 도형을 다시 그려야 합니다. ResizeableImpl 은 
+    SetWidth()/SetHeight() 에서 IBoundsListener 로 이전/새 Box 를 알리므로, 이를 모아 바뀐 
+    영역만 다시 그릴수 있습니다.
+
+    1. DamageTracker 는 IBoundsListener 를 구현하여 이전 Box 와 새 Box 를 손상 목록에 
+        추가합니다. ResizeableImpl 의 listener 는 1개 이므로, 공간 인덱스도 갱신되도록 받은 
+        알림을 다음 listener 에 전달합니다.
+    2. TakeMerged() 는 손상된 Box 들을 TileSize 크기의 타일 단위로 표시한 뒤, 가로로 이어진 
+        타일들을 사각형 1개로, 같은 가로 범위가 세로로 이어지면 다시 1개로 합칩니다. 
+        겹치는 Box 가 많아도 같은 픽셀을 여러번 그리지 않습니다.
+    3. DirtyRegionRenderer::DrawDamaged() 는 합친 영역마다 배경을 지우고, 공간 인덱스로 영역과 
+        겹치는 도형을 찾아 id 순서 (그리는 순서) 대로 영역 안만 다시 칠합니다.
+        DirtyRegionRenderer 는 도형의 Box 를 배열로 복사해 두고 알림을 받을때 갱신합니다. 
+        다시 그릴때 힙에 흩어진 도형 개체를 읽지 않기 위해서 입니다.
+    4. 이 파일에는 래스터라이저가 없으므로 도형의 Box 를 id 로 만든 색으로 채웁니다. 
+        (Shape::Draw() 의 소프트웨어 래스터라이저 구현은 추상 클래스 참고)
+*/
+// #1.
+class DamageTracker : public IBoundsListener {
+    IBoundsListener* m_Next;
+    std::vector<Box> m_Damages;
+public:
+    explicit DamageTracker(IBoundsListener* next) : m_Next(next) {}
+
+    virtual void OnBoundsChanged(std::uint32_t id, const Box& oldBox, const Box& newBox) {
+        m_Damages.push_back(oldBox);
+        m_Damages.push_back(newBox);
+        if (m_Next != NULL) m_Next->OnBoundsChanged(id, oldBox, newBox);
+    }
+    void Add(const Box& box) { m_Damages.push_back(box); }
+    bool IsEmpty() const { return m_Damages.empty(); }
+
+    // #2. screen 안의 손상 영역을 tileSize 단위로 합쳐 result 에 넣고, 손상 목록을 비웁니다.
+    void TakeMerged(const Box& screen, int tileSize, std::vector<Box>& result) {
+        result.clear();
+        const int tilesX = (screen.m_Right - screen.m_Left + tileSize - 1) / tileSize;
+        const int tilesY = (screen.m_Bottom - screen.m_Top + tileSize - 1) / tileSize;
+        std::vector<bool> dirty(static_cast<std::size_t>(tilesX) * tilesY, false);
+        for (const Box& damage : m_Damages) {
+            Box box = { std::max(damage.m_Left, screen.m_Left), std::max(damage.m_Top, screen.m_Top), 
+                std::min(damage.m_Right, screen.m_Right), std::min(damage.m_Bottom, screen.m_Bottom) };
+            if (box.m_Left >= box.m_Right || box.m_Top >= box.m_Bottom) continue;
+            for (int ty = (box.m_Top - screen.m_Top) / tileSize; ty <= (box.m_Bottom - 1 - screen.m_Top) / tileSize; ++ty) {
+                for (int tx = (box.m_Left - screen.m_Left) / tileSize; tx <= (box.m_Right - 1 - screen.m_Left) / tileSize; ++tx) {
+                    dirty[ty * tilesX + tx] = true;
+                }
+            }
+        }
+        m_Damages.clear();
+
+        std::vector<Box> previousRow; // 윗 줄에서 만든 사각형들. 가로 범위가 같으면 아래로 늘립니다.
+        std::vector<Box> currentRow;
+        for (int ty = 0; ty < tilesY; ++ty) {
+            currentRow.clear();
+            for (int tx = 0; tx < tilesX; ) {
+                if (!dirty[ty * tilesX + tx]) { ++tx; continue; }
+                int end = tx;
+                while (end < tilesX && dirty[ty * tilesX + end]) ++end;
+                Box run = { screen.m_Left + tx * tileSize, screen.m_Top + ty * tileSize, 
+                    std::min(screen.m_Left + end * tileSize, screen.m_Right), std::min(screen.m_Top + (ty + 1) * tileSize, screen.m_Bottom) };
+                currentRow.push_back(run);
+                tx = end;
+            }
+            // 윗 줄과 가로 범위가 같은 사각형은 합치고, 합쳐지지 않은 윗 줄 사각형은 결과로 보냅니다.
+            std::size_t p = 0;
+            for (Box& run : currentRow) {
+                while (p < previousRow.size() && previousRow[p].m_Left < run.m_Left) result.push_back(previousRow[p++]);
+                if (p < previousRow.size() && previousRow[p].m_Left == run.m_Left && previousRow[p].m_Right == run.m_Right) {
+                    run.m_Top = previousRow[p++].m_Top;
+                }
+            }
+            while (p < previousRow.size()) result.push_back(previousRow[p++]);
+            previousRow.swap(currentRow);
+        }
+        result.insert(result.end(), previousRow.begin(), previousRow.end());
+    }
+};
+
+// #3.
+class DirtyRegionRenderer : public IBoundsListener {
+    static constexpr int TileSize = 8;
+    static constexpr std::uint32_t Background = 0xFFFFFFFF;
+
+    int m_Width;
+    int m_Height;
+    std::vector<std::uint32_t> m_Pixels;
+    const std::vector<ResizeableImpl*>& m_Shapes;   // 인덱스가 id 이자 그리는 순서 입니다.
+    std::vector<Box> m_Bounds;                      // id 별 Box 복사본
+    ISpatialIndex& m_Index;
+    DamageTracker m_Tracker;
+    std::vector<Box> m_Regions;
+    std::vector<std::uint32_t> m_Ids;
+
+    static std::uint32_t GetColor(std::uint32_t id) { return (id * 2654435761u) | 0xFF000000; }
+
+    // #4. box 와 clip 이 겹치는 부분을 color 로 채웁니다.
+    void Fill(const Box& box, const Box& clip, std::uint32_t color) {
+        const int left = std::max(box.m_Left, clip.m_Left), right = std::min(box.m_Right, clip.m_Right);
+        const int top = std::max(box.m_Top, clip.m_Top), bottom = std::min(box.m_Bottom, clip.m_Bottom);
+        for (int y = top; y < bottom; ++y) {
+            std::uint32_t* row = &m_Pixels[static_cast<std::size_t>(y) * m_Width];
+            std::fill(row + left, row + std::max(left, right), color);
+        }
+    }
+public:
+    DirtyRegionRenderer(int width, int height, const std::vector<ResizeableImpl*>& shapes, ISpatialIndex& index) :
+        m_Width(width),
+        m_Height(height),
+        m_Pixels(static_cast<std::size_t>(width) * height, Background),
+        m_Shapes(shapes),
+        m_Index(index),
+        m_Tracker(&index) {
+        for (std::uint32_t id = 0; id < m_Shapes.size(); ++id) {
+            m_Bounds.push_back(m_Shapes[id]->GetBounds());
+            m_Shapes[id]->SetListener(this, id); // 크기가 바뀌면 this -> m_Tracker -> m_Index 순으로 알립니다.
+        }
+        m_Index.Build(m_Bounds);
+    }
+    ~DirtyRegionRenderer() {
+        for (ResizeableImpl* shape : m_Shapes) shape->SetListener(NULL, 0);
+    }
+    DirtyRegionRenderer(const DirtyRegionRenderer&) = delete;
+    DirtyRegionRenderer& operator =(const DirtyRegionRenderer&) = delete;
+
+    const std::vector<std::uint32_t>& GetPixels() const { return m_Pixels; }
+
+    virtual void OnBoundsChanged(std::uint32_t id, const Box& oldBox, const Box& newBox) {
+        m_Bounds[id] = newBox;
+        m_Tracker.OnBoundsChanged(id, oldBox, newBox);
+    }
+
+    // 모든 도형을 다시 그립니다. 손상 목록은 비웁니다.
+    void DrawAll() {
+        const Box screen = { 0, 0, m_Width, m_Height };
+        m_Tracker.TakeMerged(screen, TileSize, m_Regions);
+        std::fill(m_Pixels.begin(), m_Pixels.end(), Background);
+        for (std::uint32_t id = 0; id < m_Bounds.size(); ++id) Fill(m_Bounds[id], screen, GetColor(id));
+    }
+    // #3. 손상된 영역만 다시 그립니다.
+    void DrawDamaged() {
+        const Box screen = { 0, 0, m_Width, m_Height };
+        m_Tracker.TakeMerged(screen, TileSize, m_Regions);
+        for (const Box& region : m_Regions) {
+            Fill(region, region, Background);
+            m_Index.QueryBox(region, m_Ids);
+            std::sort(m_Ids.begin(), m_Ids.end()); // 원래 그리는 순서
+            for (std::uint32_t id : m_Ids) Fill(m_Bounds[id], region, GetColor(id));
+        }
+    }
+    std::size_t GetRegionCount() const { return m_Regions.size(); }
+};
+
+/*      변경된 영역만 다시 그리기 측정      */
+// 도형 10^6 개 중 1% 의 크기를 매 프레임 바꾸고, 전체를 다시 그리는 시간과 손상 영역만 다시 
+//  그리는 시간을 비교합니다. 두 결과의 픽셀이 같은지도 확인합니다.
+const int width = 4096, height = 4096;
+const int shapeCount = 1000000;
+const int frameCount = 10;
+std::vector<Rectangle*> rects;
+std::vector<ResizeableImpl*> shapes;
+for (int i = 0; i < shapeCount; ++i) {
+    rects.push_back(new Rectangle(std::rand() % width, std::rand() % height, 1 + std::rand() % 16, 1 + std::rand() % 16));
+    shapes.push_back(rects.back());
+}
+
+{
+    Box world = { 0, 0, width, height };
+    UniformGrid grid(world, 32); // 갱신이 잦으므로 grid 를 사용합니다.
+    DirtyRegionRenderer incremental(width, height, shapes, grid);
+    incremental.DrawAll();
+
+    double fullMs = 0, damagedMs = 0;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (int i = 0; i < shapeCount / 100; ++i) { // 1% 의 크기를 바꿉니다.
+            Rectangle* rect = rects[std::rand() % shapeCount];
+            rect->SetWidth(1 + std::rand() % 16);
+        }
+        damagedMs += MeasureMs([&]() { incremental.DrawDamaged(); });
+        std::vector<std::uint32_t> damaged = incremental.GetPixels();
+        fullMs += MeasureMs([&]() { incremental.DrawAll(); });
+        EXPECT_TRUE(damaged == incremental.GetPixels()); // 전체를 다시 그린것과 같아야 합니다.
+    }
+    std::cout << "frame ms - full: " << fullMs / frameCount << " damaged: " << damagedMs / frameCount << std::endl;
+} // incremental 이 도형들의 listener 를 해제한 뒤에 도형들을 소멸합니다.
+for (Rectangle* rect : rects) delete rect;
+// 1% 라도 도형이 화면 전체에 흩어져 있으면 손상 영역이 넓어집니다. (손상 Box 2만개) 
+//  타일이 크면 화면 대부분이 손상되어 전체를 다시 그리는 것과 차이가 없어지므로 타일 크기를 
+//  작게 하였습니다. 손상 영역 넓이가 화면의 일정 비율을 넘으면 DrawAll() 을 호출하세요.
+
+/*      Arena 에 한꺼번에 복제하기 - 장면 스냅샷      */
+/*
+가상 복사 생성자 Clone() 으로 도형 N 개의 스냅샷을 만들면 new 가 N 번, 나중에 delete 가 
+    N 번 일어납니다. 스냅샷은 통째로 만들고 통째로 버리므로, 큰 메모리 블록에서 순서대로 
+    잘라 쓰고 (monotonic) 한번에 해제할수 있습니다.
+
+    1. Arena 는 블록을 할당해 두고 포인터를 증가시키며 메모리를 나눠 줍니다. 블록이 부족하면 
+        이전보다 2배 큰 블록을 추가하므로 블록 수는 사용량의 log 에 비례합니다. 
+        Release() 는 블록들만 해제하며, 개체 수와 무관합니다. Reset() 은 가장 큰 블록 1개를 
+        남겨 다음 스냅샷에서 재사용합니다.
+    2. Arena 는 개체의 소멸자를 호출하지 않습니다. 따라서 New<T>() 는 소멸자가 하는 일이 
+        없는 타입만 허용합니다. Rectangle, Ellipse 는 가상 소멸자가 있어 
+        std::is_trivially_destructible 은 아니지만, 멤버가 int 뿐이어서 소멸자가 하는 일이 
+        없으므로 SkipDestructorInArena 를 특수화하여 허용합니다. 나중에 std::string 같은 
+        멤버를 추가하면 소멸자를 호출하지 않아 누수되므로, 특수화한 클래스의 크기를 
+        static_assert 로 검사하여 멤버가 바뀌면 컴파일 오류가 나게 합니다.
+    3. Clone() 과 함께 CloneInto(Arena&) 를 가상 함수로 제공합니다. 자식 개체의 복사 생성자로 
+        arena 에 복제합니다. CloneInto() 로 만든 개체는 delete 하면 안됩니다.
+    4. SceneSnapshot 은 Shape* 들을 arena 1개에 복제합니다. 포인터 배열도 arena 에 할당하므로 
+        스냅샷을 만들때 힙 할당은 블록 수 만큼만 일어납니다.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// #2. 소멸자를 호출하지 않아도 되는 타입 입니다.
+template<typename T>
+struct SkipDestructorInArena : std::is_trivially_destructible<T> {};
+
+// #1.
+class Arena {
+    struct Block {
+        Block* m_Prev;
+        std::size_t m_Size; // Block 헤더를 포함한 크기
+    };
+    static const std::size_t InitialSize = 64 * 1024;
+
+    Block* m_Head;      // 마지막에 추가한 (가장 큰) 블록
+    char* m_Current;    // m_Head 에서 다음에 나눠줄 위치
+    char* m_End;
+
+    void AddBlock(std::size_t minSize) {
+        std::size_t size = m_Head != NULL ? m_Head->m_Size * 2 : InitialSize;
+        while (size < minSize + sizeof(Block)) size *= 2;
+        Block* block = static_cast<Block*>(::operator new(size));
+        block->m_Prev = m_Head;
+        block->m_Size = size;
+        m_Head = block;
+        m_Current = reinterpret_cast<char*>(block + 1);
+        m_End = reinterpret_cast<char*>(block) + size;
+    }
+public:
+    Arena() : m_Head(NULL), m_Current(NULL), m_End(NULL) {}
+    ~Arena() { Release(); }
+    Arena(const Arena&) = delete;
+    Arena& operator =(const Arena&) = delete;
+
+    // align 은 2의 거듭제곱이며 alignof(std::max_align_t) 이하여야 합니다.
+    void* Allocate(std::size_t size, std::size_t align) {
+        std::size_t padding = (align - reinterpret_cast<std::uintptr_t>(m_Current) % align) % align;
+        if (m_Current == NULL || static_cast<std::size_t>(m_End - m_Current) < padding + size) {
+            AddBlock(size + align);
+            padding = (align - reinterpret_cast<std::uintptr_t>(m_Current) % align) % align;
+        }
+        void* result = m_Current + padding;
+        m_Current += padding + size;
+        return result;
+    }
+    template<typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(SkipDestructorInArena<T>::value, "Arena does not call destructors"); // #2
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 모든 블록을 해제합니다. 나눠준 메모리는 모두 무효화됩니다.
+    void Release() {
+        while (m_Head != NULL) {
+            Block* prev = m_Head->m_Prev;
+            ::operator delete(m_Head);
+            m_Head = prev;
+        }
+        m_Current = NULL;
+        m_End = NULL;
+    }
+    // 가장 큰 블록만 남기고 해제한 뒤 처음부터 다시 나눠 줍니다.
+    void Reset() {
+        if (m_Head == NULL) return;
+        Block* head = m_Head;
+        m_Head = head->m_Prev;
+        Release();
+        head->m_Prev = NULL;
+        m_Head = head;
+        m_Current = reinterpret_cast<char*>(head + 1);
+        m_End = reinterpret_cast<char*>(head) + head->m_Size;
+    }
+};
+
+// #2. 멤버가 int 뿐이어서 소멸자가 하는 일이 없습니다.
+//  CloneInto() 에서 arena.New<Rectangle>() 을 사용하기 전에 특수화해야 합니다.
+class Rectangle;
+class Ellipse;
+template<> struct SkipDestructorInArena<Rectangle> : std::true_type {};
+template<> struct SkipDestructorInArena<Ellipse> : std::true_type {};
+
+class Shape {
+    int m_Left;
+    int m_Top;
+    int m_Width;
+    int m_Height;
+protected:
+    Shape(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    Shape(const Shape& other) = default; // 자식 개체에서만 사용할 수 있게끔 protected 입니다.
+    Shape& operator =(const Shape& other) = default;
+public:
+    virtual ~Shape() {}
+    virtual Shape* Clone() const = 0;
+    virtual Shape* CloneInto(Arena& arena) const = 0; // #3. 반환값을 delete 하면 안됩니다.
+
+    int GetLeft() const { return m_Left; }
+    int GetTop() const { return m_Top; }
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+};
+
+class Rectangle : public Shape {
+public:
+    Rectangle(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual Rectangle* Clone() const { return new Rectangle(*this); }
+    virtual Rectangle* CloneInto(Arena& arena) const { return arena.New<Rectangle>(*this); }
+};
+class Ellipse : public Shape {
+public:
+    Ellipse(int l, int t, int w, int h) : Shape(l, t, w, h) {}
+    virtual Ellipse* Clone() const { return new Ellipse(*this); }
+    virtual Ellipse* CloneInto(Arena& arena) const { return arena.New<Ellipse>(*this); }
+};
+// #2. 특수화의 전제를 검사합니다. 가상 함수 테이블 포인터와 int 4개 뿐입니다.
+static_assert(sizeof(Shape) == sizeof(void*) + 4 * sizeof(int), "Shape members changed. Review SkipDestructorInArena specializations");
+static_assert(sizeof(Rectangle) == sizeof(Shape), "Rectangle members changed. Review SkipDestructorInArena<Rectangle>");
+static_assert(sizeof(Ellipse) == sizeof(Shape), "Ellipse members changed. Review SkipDestructorInArena<Ellipse>");
+
+// #4.
+class SceneSnapshot {
+    Arena m_Arena;
+    const Shape** m_Shapes;
+    std::size_t m_Count;
+public:
+    SceneSnapshot() : m_Shapes(NULL), m_Count(0) {}
+    SceneSnapshot(const SceneSnapshot&) = delete;
+    SceneSnapshot& operator =(const SceneSnapshot&) = delete;
+
+    // 이전 스냅샷을 버리고 shapes 를 복제합니다. 이전 메모리는 재사용합니다.
+    void Take(const Shape* const* shapes, std::size_t count) {
+        m_Arena.Reset();
+        m_Shapes = static_cast<const Shape**>(m_Arena.Allocate(sizeof(const Shape*) * count, alignof(const Shape*)));
+        for (std::size_t i = 0; i < count; ++i) {
+            m_Shapes[i] = shapes[i]->CloneInto(m_Arena);
+        }
+        m_Count = count;
+    }
+    // 스냅샷의 메모리를 모두 해제합니다. 도형 수와 무관합니다.
+    void Release() {
+        m_Arena.Release();
+        m_Shapes = NULL;
+        m_Count = 0;
+    }
+    std::size_t GetCount() const { return m_Count; }
+    const Shape& Get(std::size_t index) const { return *m_Shapes[index]; }
+};
+
+{
+    Shape* shapes[2] = {
+        new Rectangle(0, 0, 10, 20),
+        new Ellipse(5, 5, 30, 40)
+    };
+    SceneSnapshot snapshot;
+    snapshot.Take(shapes, 2);
+
+    // (0) 자식 개체의 타입으로 잘 복제 됩니다.
+    EXPECT_TRUE(typeid(snapshot.Get(0)) == typeid(Rectangle));
+    EXPECT_TRUE(typeid(snapshot.Get(1)) == typeid(Ellipse));
+    EXPECT_TRUE(snapshot.Get(1).GetWidth() == 30 && &snapshot.Get(1) != shapes[1]);
+
+    snapshot.Release(); // (0) delete 없이 한번에 해제합니다.
+
+    for (int i = 0; i < 2; ++i) {
+        delete shapes[i];
+    }
+}
+
+/*      스냅샷 측정 - Clone()/delete 와 Arena 비교     */
+// 도형 10^6 개의 스냅샷을 만들고 해제하는 시간을 비교합니다. 
+//  Arena 는 처음 (블록 할당 포함) 과 Reset() 으로 블록을 재사용하는 2번째를 각각 측정합니다.
+const int count = 1000000;
+std::vector<Shape*> scene;
+for (int i = 0; i < count; ++i) {
+    if (i % 2 == 0) scene.push_back(new Rectangle(std::rand() % 1000, std::rand() % 1000, std::rand() % 100, std::rand() % 100));
+    else scene.push_back(new Ellipse(std::rand() % 1000, std::rand() % 1000, std::rand() % 100, std::rand() % 100));
+}
+
+std::vector<Shape*> clones(count);
+double cloneMs = MeasureMs([&]() { for (int i = 0; i < count; ++i) clones[i] = scene[i]->Clone(); });
+double deleteMs = MeasureMs([&]() { for (int i = 0; i < count; ++i) delete clones[i]; });
+
+SceneSnapshot snapshot;
+double firstMs = MeasureMs([&]() { snapshot.Take(scene.data(), scene.size()); });
+double reuseMs = MeasureMs([&]() { snapshot.Take(scene.data(), scene.size()); }); // 블록 재사용
+EXPECT_TRUE(snapshot.GetCount() == scene.size() && snapshot.Get(count - 1).GetTop() == scene[count - 1]->GetTop());
+double releaseMs = MeasureMs([&]() { snapshot.Release(); });
+
+std::cout << "Clone() ms: " << cloneMs << " delete ms: " << deleteMs << std::endl;
+std::cout << "CloneInto() ms first: " << firstMs << " reuse: " << reuseMs << " Release() ms: " << releaseMs << std::endl;
+
+for (Shape* shape : scene) delete shape;
+// Arena 는 할당이 포인터 증가뿐이고, 복제본들이 메모리에 연속으로 놓여 순회도 빠릅니다. 
+//  Release() 는 블록 몇개만 해제하므로 도형 수와 무관합니다.
+
+/*      AnyShape - 상속 없는 값 타입 다형성      */
+/*
+Shape* 와 Clone(), delete 로 다루면 포인터 의미 (pointer semantics) 이고 도형마다 힙 할당이 
+    있으며, 모든 도형이 Shape 을 상속해야 합니다. 
+    AnyShape 은 Draw() 를 가진 어떤 타입이든 값으로 보관하는 타입 소거 (type erasure) 
+    값 타입입니다. (Sean Parent 의 "Inheritance Is The Base Class of Evil" 방식)
+
+    1. Rectangle, Ellipse 는 Shape 을 상속하지 않는 일반 값 타입이고, Draw(Canvas&) 만 제공합니다.
+    2. AnyShape 은 보관한 타입별로 Draw/Clone/Move/Destroy 함수 테이블 (Ops) 을 1개씩 만들어 
+        가리킵니다. 가상 함수 테이블을 직접 만든 것과 같습니다. (ClonePtr 참고)
+    3. BufferSize 이하이고 예외 없이 이동할수 있는 타입은 m_Buffer 에 생성하여 힙 할당이 
+        없습니다. 큰 타입은 힙에 생성합니다.
+    4. 복사는 같은 방식 (m_Buffer 나 힙) 으로 복제하고, 이동은 m_Buffer 면 개체를 이동 생성, 
+        힙이면 포인터만 옮깁니다. 대입은 복사 후 바꿔치기 (copy-and-swap) 입니다.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+struct Canvas {
+    std::int64_t m_Pixels; // 측정을 위해 출력 대신 칠한 픽셀 수를 누적합니다.
+    Canvas() : m_Pixels(0) {}
+};
+
+class AnyShape {
+    static const std::size_t BufferSize = 4 * sizeof(void*);
+
+    // #2.
+    struct Ops {
+        void (*Draw)(const void* obj, Canvas& canvas);
+        void (*Clone)(const AnyShape& src, AnyShape& dst);
+        void (*Move)(AnyShape& src, AnyShape& dst);   // 예외를 발생하지 않습니다.
+        void (*Destroy)(AnyShape& shape);             // 예외를 발생하지 않습니다.
+    };
+
+    alignas(std::max_align_t) unsigned char m_Buffer[BufferSize];
+    void* m_Ptr;        // m_Buffer 나 힙 개체를 가리킵니다.
+    const Ops* m_Ops;   // NULL 이면 비었습니다.
+
+    // #3.
+    template<typename U>
+    static constexpr bool FitsInline() {
+        return sizeof(U) <= BufferSize && 
+            alignof(U) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<U>::value;
+    }
+    template<typename U>
+    static const Ops* InlineOps() {
+        static const Ops ops = {
+            [](const void* obj, Canvas& canvas) { static_cast<const U*>(obj)->Draw(canvas); },
+            [](const AnyShape& src, AnyShape& dst) { dst.m_Ptr = new(dst.m_Buffer) U(*static_cast<const U*>(src.m_Ptr)); },
+            [](AnyShape& src, AnyShape& dst) {
+                dst.m_Ptr = new(dst.m_Buffer) U(std::move(*static_cast<U*>(src.m_Ptr)));
+                static_cast<U*>(src.m_Ptr)->~U();
+                src.m_Ptr = nullptr;
+            },
+            [](AnyShape& shape) { static_cast<U*>(shape.m_Ptr)->~U(); }
+        };
+        return &ops;
+    }
+    template<typename U>
+    static const Ops* HeapOps() {
+        static const Ops ops = {
+            [](const void* obj, Canvas& canvas) { static_cast<const U*>(obj)->Draw(canvas); },
+            [](const AnyShape& src, AnyShape& dst) { dst.m_Ptr = new U(*static_cast<const U*>(src.m_Ptr)); },
+            [](AnyShape& src, AnyShape& dst) { dst.m_Ptr = src.m_Ptr; src.m_Ptr = nullptr; }, // 포인터만 옮깁니다.
+            [](AnyShape& shape) { delete static_cast<U*>(shape.m_Ptr); }
+        };
+        return &ops;
+    }
+public:
+    AnyShape() noexcept : m_Ptr(nullptr), m_Ops(nullptr) {}
+
+    // #1. Draw(Canvas&) const 를 가진 어떤 타입이든 보관합니다. 
+    template<typename U, typename = typename std::enable_if<!std::is_same<typename std::decay<U>::type, AnyShape>::value>::type>
+    AnyShape(U&& shape) : AnyShape() {
+        typedef typename std::decay<U>::type Type;
+        if constexpr (FitsInline<Type>()) {
+            m_Ptr = new(m_Buffer) Type(std::forward<U>(shape));
+            m_Ops = InlineOps<Type>();
+        }
+        else {
+            m_Ptr = new Type(std::forward<U>(shape));
+            m_Ops = HeapOps<Type>();
+        }
+    }
+    // #4.
+    AnyShape(const AnyShape& other) : AnyShape() {
+        if (other.m_Ops != nullptr) {
+            other.m_Ops->Clone(other, *this);
+            m_Ops = other.m_Ops; // 복제에 성공한 뒤에 설정하므로 예외가 발생해도 비어 있습니다.
+        }
+    }
+    AnyShape(AnyShape&& other) noexcept : AnyShape() {
+        MoveFrom(other);
+    }
+    ~AnyShape() { Reset(); }
+
+    AnyShape& operator =(AnyShape other) noexcept {
+        Swap(other);
+        return *this;
+    }
+    void Swap(AnyShape& other) noexcept {
+        AnyShape temp;
+        temp.MoveFrom(other);
+        other.MoveFrom(*this);
+        MoveFrom(temp);
+    }
+
+    // 비어 있지 않아야 합니다.
+    void Draw(Canvas& canvas) const { m_Ops->Draw(m_Ptr, canvas); }
+
+    bool IsEmpty() const { return m_Ops == nullptr; }
+    bool IsInline() const { return m_Ptr != nullptr && static_cast<const void*>(m_Ptr) == m_Buffer; }
+private:
+    // this 는 비어 있어야 합니다.
+    void MoveFrom(AnyShape& other) noexcept {
+        if (other.m_Ops == nullptr) return;
+        other.m_Ops->Move(other, *this);
+        m_Ops = other.m_Ops;
+        other.m_Ops = nullptr;
+    }
+    void Reset() noexcept {
+        if (m_Ops != nullptr) m_Ops->Destroy(*this);
+        m_Ptr = nullptr;
+        m_Ops = nullptr;
+    }
+};
+
+// #1. Shape 을 상속하지 않습니다.
+class Rectangle {
+    int m_Left, m_Top, m_Width, m_Height;
+public:
+    Rectangle(int l, int t, int w, int h) : m_Left(l), m_Top(t), m_Width(w), m_Height(h) {}
+    void Draw(Canvas& canvas) const { canvas.m_Pixels += static_cast<std::int64_t>(m_Width) * m_Height; }
+};
+class Ellipse {
+    int m_CenterX, m_CenterY, m_Width, m_Height;
+public:
+    Ellipse(int centerX, int centerY, int w, int h) : m_CenterX(centerX), m_CenterY(centerY), m_Width(w), m_Height(h) {}
+    void Draw(Canvas& canvas) const { canvas.m_Pixels += static_cast<std::int64_t>(m_Width) * m_Height * 785 / 1000; }
+};
+// 꼭지점이 많아 m_Buffer 에 들어가지 않으므로 힙에 생성됩니다.
+class Polygon {
+    int m_Points[16][2];
+public:
+    Polygon() : m_Points() {}
+    void Draw(Canvas& canvas) const { canvas.m_Pixels += 1; }
+};
+
+{
+    std::vector<AnyShape> shapes;
+    shapes.push_back(Rectangle(0, 0, 10, 20));
+    shapes.push_back(Ellipse(50, 50, 10, 20));
+    shapes.push_back(Polygon());
+    EXPECT_TRUE(shapes[0].IsInline() && !shapes[2].IsInline()); // (0) 작은 도형은 힙 할당이 없습니다.
+
+    std::vector<AnyShape> copies = shapes; // (0) 값 타입이어서 복사하면 복제됩니다. Clone() 이 필요 없습니다.
+    shapes.clear();                        // (0) delete 가 필요 없습니다.
+
+    Canvas canvas;
+    for (const AnyShape& shape : copies) shape.Draw(canvas);
+    EXPECT_TRUE(canvas.m_Pixels == 200 + 200 * 785 / 1000 + 1);
+}
+
+/*      AnyShape 측정 - Shape*, unique_ptr<Shape> 과 비교     */
+// 도형 10^6 개를 만들고, 전체를 복사 (Clone), 그리기, 소멸하는 시간을 비교합니다.
+//  Shape 계층의 도형은 값 타입과 이름이 겹치므로 ShapeRectangle, ShapeEllipse 라 하겠습니다.
+#include <memory>
+
+class Shape {
+protected:
+    Shape() {}
+    Shape(const Shape& other) = default;
+public:
+    virtual ~Shape() {}
+    virtual Shape* Clone() const = 0;
+    virtual void Draw(Canvas& canvas) const = 0;
+};
+class ShapeRectangle : public Shape {
+    Rectangle m_Impl;
+public:
+    ShapeRectangle(int l, int t, int w, int h) : m_Impl(l, t, w, h) {}
+    virtual ShapeRectangle* Clone() const { return new ShapeRectangle(*this); }
+    virtual void Draw(Canvas& canvas) const { m_Impl.Draw(canvas); }
+};
+class ShapeEllipse : public Shape {
+    Ellipse m_Impl;
+public:
+    ShapeEllipse(int centerX, int centerY, int w, int h) : m_Impl(centerX, centerY, w, h) {}
+    virtual ShapeEllipse* Clone() const { return new ShapeEllipse(*this); }
+    virtual void Draw(Canvas& canvas) const { m_Impl.Draw(canvas); }
+};
+
+const int count = 1000000;
+std::vector<int> values;
+for (int i = 0; i < count * 2; ++i) values.push_back(std::rand() % 100);
+
+Canvas c1, c2, c3;
+{
+    std::vector<Shape*> shapes, copies;
+    shapes.reserve(count); // vector 재할당은 측정하지 않습니다.
+    copies.reserve(count);
+    double buildMs = MeasureMs([&]() {
+        for (int i = 0; i < count; ++i) {
+            if (i % 2 == 0) shapes.push_back(new ShapeRectangle(0, 0, values[2 * i], values[2 * i + 1]));
+            else shapes.push_back(new ShapeEllipse(0, 0, values[2 * i], values[2 * i + 1]));
+        }
+    });
+    double copyMs = MeasureMs([&]() { for (Shape* shape : shapes) copies.push_back(shape->Clone()); });
+    double drawMs = MeasureMs([&]() { for (Shape* shape : copies) shape->Draw(c1); });
+    double destroyMs = MeasureMs([&]() {
+        for (Shape* shape : shapes) delete shape;
+        for (Shape* shape : copies) delete shape;
+    });
+    std::cout << "Shape* ms - build: " << buildMs << " copy: " << copyMs << " draw: " << drawMs << " destroy: " << destroyMs << std::endl;
+}
+{
+    std::vector<std::unique_ptr<Shape>> shapes, copies;
+    shapes.reserve(count); // vector 재할당은 측정하지 않습니다.
+    copies.reserve(count);
+    double buildMs = MeasureMs([&]() {
+        for (int i = 0; i < count; ++i) {
+            if (i % 2 == 0) shapes.push_back(std::unique_ptr<Shape>(new ShapeRectangle(0, 0, values[2 * i], values[2 * i + 1])));
+            else shapes.push_back(std::unique_ptr<Shape>(new ShapeEllipse(0, 0, values[2 * i], values[2 * i + 1])));
+        }
+    });
+    double copyMs = MeasureMs([&]() { for (const std::unique_ptr<Shape>& shape : shapes) copies.push_back(std::unique_ptr<Shape>(shape->Clone())); });
+    double drawMs = MeasureMs([&]() { for (const std::unique_ptr<Shape>& shape : copies) shape->Draw(c2); });
+    double destroyMs = MeasureMs([&]() {
+        shapes.clear();
+        copies.clear();
+    });
+    std::cout << "unique_ptr<Shape> ms - build: " << buildMs << " copy: " << copyMs << " draw: " << drawMs << " destroy: " << destroyMs << std::endl;
+}
+{
+    std::vector<AnyShape> shapes, copies;
+    shapes.reserve(count); // vector 재할당은 측정하지 않습니다.
+    double buildMs = MeasureMs([&]() {
+        for (int i = 0; i < count; ++i) {
+            if (i % 2 == 0) shapes.push_back(Rectangle(0, 0, values[2 * i], values[2 * i + 1]));
+            else shapes.push_back(Ellipse(0, 0, values[2 * i], values[2 * i + 1]));
+        }
+    });
+    double copyMs = MeasureMs([&]() { copies = shapes; });
+    double drawMs = MeasureMs([&]() { for (const AnyShape& shape : copies) shape.Draw(c3); });
+    double destroyMs = MeasureMs([&]() {
+        shapes.clear();
+        copies.clear();
+    });
+    std::cout << "AnyShape ms - build: " << buildMs << " copy: " << copyMs << " draw: " << drawMs << " destroy: " << destroyMs << std::endl;
+}
+EXPECT_TRUE(c1.m_Pixels == c2.m_Pixels && c2.m_Pixels == c3.m_Pixels);
+// AnyShape 은 도형이 std::vector 에 연속으로 놓이므로 도형마다 할당이 없고, 
+//  그리기도 흩어진 힙을 읽지 않습니다. 대신 std::vector 가 커질때 요소마다 Move 함수를 
+//  호출하므로, 개수를 안다면 reserve() 하세요.
+
+/*      상수 시간 형변환 - dynamic_cast 대체      */
+/*
+dynamic_cast<Idol*>(singer) 나 형제 개체로의 dynamic_cast<IDancer*>(singer) 는 RTTI 의 
+    상속 트리를 탐색하므로 수백 사이클이 걸릴수 있고, 형제 개체로의 형변환 (cross cast) 이 
+    가장 느립니다. 자주 형변환하는 클래스만 선택적으로 다음 방식을 사용할수 있습니다.
+
+    1. CastTypeId<T>() 는 타입마다 0 부터 순서대로 작은 정수 id 를 부여합니다.
+    2. CastTable 은 구체 클래스 1개의 표입니다. 대상 타입 id 를 인덱스로 하여, 구체 개체의 
+        시작 주소에서 대상 타입 부분 개체까지의 거리 (offset) 를 가집니다. 상속하지 않은 
+        타입은 None 입니다.
+    3. ICastable 은 형변환할 인터페이스들이 상속하는 인터페이스입니다. GetCastTarget() 는 
+        구체 개체의 시작 주소와 CastTable 을 돌려줍니다.
+    4. Castable<Derived, Bases...> 는 Bases 를 상속하고, GetCastTarget() 를 구현합니다. 
+        CastTable 은 처음 GetCastTarget() 을 호출한 개체로 1번 만듭니다. 
+        (함수내 정적 지역 변수여서 쓰레드에 안전합니다.) 개체가 없는 주소를 Derived* 로 
+        간주하여 부모로 형변환하면 수명 전 개체 사용이어서 정의되지 않은 동작입니다. 
+        Derived 는 final 이어야 합니다. Derived 를 상속한 클래스는 Derived 의 표를 
+        사용하게 되어 IsExactType<Derived>() 가 잘못된 결과를 주므로 컴파일 오류로 막습니다.
+    5. FastCast<Target>(source) 는 가상 함수 호출 1번, 표 조회 1번, 포인터 덧셈 1번으로 
+        down casting 과 sibling casting 을 합니다. 실패하면 NULL 입니다.
+
+(~) 주의. Bases 에 나열한 타입과 Derived 로만 형변환할수 있습니다. 가상 상속은 지원하지 
+    않습니다. (부모 개체의 위치가 개체마다 다를수 있습니다.)
+*/
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// #1.
+inline std::uint32_t NextCastTypeId() {
+    static std::atomic<std::uint32_t> s_Next(0);
+    return s_Next++;
+}
+template<typename T>
+std::uint32_t CastTypeId() {
+    static const std::uint32_t s_Id = NextCastTypeId();
+    return s_Id;
+}
+
+// #2.
+struct CastTable {
+    static constexpr std::ptrdiff_t None = PTRDIFF_MIN;
+
+    std::uint32_t m_TypeId;                 // 구체 클래스의 id. typeid 대신 비교합니다.
+    std::vector<std::ptrdiff_t> m_Offsets;  // 대상 타입 id 별 offset
+
+    std::ptrdiff_t GetOffset(std::uint32_t targetId) const {
+        return targetId < m_Offsets.size() ? m_Offsets[targetId] : None;
+    }
+};
+
+struct CastTarget {
+    void* m_Object;             // 구체 개체의 시작 주소
+    const CastTable* m_Table;
+};
+
+// #3.
+class ICastable {
+protected:
+    ~ICastable() {} // 인터페이스여서 protected non-virtual 입니다.
+public:
+    virtual CastTarget GetCastTarget() const = 0;
+};
+
+// #4.
+template<typename Derived, typename... Bases>
+class Castable : public Bases... {
+    // 살아있는 개체로 부모 개체까지의 거리를 계산합니다. 
+    // 가상 상속이 아니므로 거리는 모든 Derived 개체에서 같습니다.
+    static CastTable MakeTable(const Derived* derived) {
+        CastTable table;
+        table.m_TypeId = CastTypeId<Derived>();
+        Add(table, CastTypeId<Derived>(), 0);
+        (Add(table, CastTypeId<Bases>(), 
+            reinterpret_cast<const char*>(static_cast<const Bases*>(derived)) - reinterpret_cast<const char*>(derived)), ...);
+        return table;
+    }
+    static void Add(CastTable& table, std::uint32_t id, std::ptrdiff_t offset) {
+        if (table.m_Offsets.size() <= id) table.m_Offsets.resize(id + 1, CastTable::None);
+        table.m_Offsets[id] = offset;
+    }
+    static const CastTable& GetCastTable(const Derived* derived) {
+        static const CastTable s_Table = MakeTable(derived); // 처음 호출한 개체로 1번 만듭니다.
+        return s_Table;
+    }
+public:
+    // 모든 Bases 의 ICastable::GetCastTarget() 을 구현합니다.
+    virtual CastTarget GetCastTarget() const final {
+        // Derived 를 상속한 클래스는 Derived 의 표를 그대로 사용하므로, 상속하지 못하게 합니다.
+        //  (클래스 정의 안에서는 Derived 가 아직 불완전한 타입이어서 여기서 검사합니다.)
+        static_assert(std::is_final<Derived>::value, "Castable Derived must be final");
+        const Derived* derived = static_cast<const Derived*>(this);
+        CastTarget target = { const_cast<Derived*>(derived), &GetCastTable(derived) };
+        return target;
+    }
+};
+
+// #5.
+template<typename Target, typename Source>
+Target* FastCast(Source* source) {
+    if (source == NULL) return NULL;
+    CastTarget target = source->GetCastTarget();
+    std::ptrdiff_t offset = target.m_Table->GetOffset(CastTypeId<typename std::remove_const<Target>::type>());
+    if (offset == CastTable::None) return NULL;
+    return reinterpret_cast<Target*>(static_cast<char*>(target.m_Object) + offset);
+}
+// typeid(*source) == typeid(T) 와 같습니다.
+template<typename T, typename Source>
+bool IsExactType(const Source* source) {
+    return source->GetCastTarget().m_Table->m_TypeId == CastTypeId<T>();
+}
+
+class ISinger : public ICastable {
+protected:
+    ~ISinger() {}
+public:
+    virtual void Sing() const = 0;
+};
+class IDancer : public ICastable {
+protected:
+    ~IDancer() {}
+public:
+    virtual void Dance() const = 0;
+};
+class Idol final : public Castable<Idol, ISinger, IDancer> {
+public:
+    virtual void Sing() const {}
+    virtual void Dance() const {}
+};
+class Singer final : public Castable<Singer, ISinger> { // 춤은 추지 않습니다.
+public:
+    virtual void Sing() const {}
+};
+
+// RTTI 와 형변환의 EXPECT 들을 FastCast 로 바꾼 것입니다.
+{
+    Idol obj;
+    ISinger* singer = &obj; // (0) Up casting 은 형변환이 필요 없습니다.
+    IDancer* dancer = &obj;
+
+    Idol* idol = FastCast<Idol>(singer);        // (0) down casting
+    IDancer* sibling = FastCast<IDancer>(singer); // (0) sibling casting
+
+    EXPECT_TRUE(idol == &obj);
+    EXPECT_TRUE(sibling == dancer);
+    EXPECT_TRUE(FastCast<ISinger>(dancer) == singer);
+    EXPECT_TRUE(FastCast<const Idol>(static_cast<const IDancer*>(dancer)) == &obj);
+    EXPECT_TRUE(IsExactType<Idol>(idol));
+    EXPECT_TRUE(IsExactType<Idol>(singer));
+    EXPECT_TRUE(IsExactType<Idol>(dancer));
+
+    Singer singerOnly;
+    singer = &singerOnly;
+    EXPECT_TRUE(FastCast<Idol>(singer) == NULL);    // (0) 실패하면 NULL 입니다.
+    EXPECT_TRUE(FastCast<IDancer>(singer) == NULL);
+    EXPECT_TRUE(!IsExactType<Idol>(singer) && IsExactType<Singer>(singer));
+    EXPECT_TRUE(FastCast<IDancer>(static_cast<ISinger*>(NULL)) == NULL);
+
+    // dynamic_cast 와 결과가 같습니다.
+    EXPECT_TRUE(dynamic_cast<IDancer*>(static_cast<ISinger*>(&obj)) == FastCast<IDancer>(static_cast<ISinger*>(&obj)));
+}
+
+/*      FastCast 측정 - dynamic_cast 와 비교      */
+// Idol 과 Singer 가 섞인 ISinger* 10^6 개를 Idol* 로 down casting, IDancer* 로 sibling 
+//  casting 하는 시간을 비교합니다.
+const int count = 1000000;
+std::vector<Idol> idols(count / 2);
+std::vector<Singer> singers(count / 2);
+std::vector<ISinger*> performers;
+for (int i = 0; i < count / 2; ++i) {
+    performers.push_back(&idols[i]);
+    performers.push_back(&singers[i]);
+}
+
+std::size_t dynamicDown = 0, dynamicCross = 0, fastDown = 0, fastCross = 0;
+double dynamicDownMs = MeasureMs([&]() { for (ISinger* p : performers) dynamicDown += dynamic_cast<Idol*>(p) != NULL; });
+double dynamicCrossMs = MeasureMs([&]() { for (ISinger* p : performers) dynamicCross += dynamic_cast<IDancer*>(p) != NULL; });
+double fastDownMs = MeasureMs([&]() { for (ISinger* p : performers) fastDown += FastCast<Idol>(p) != NULL; });
+double fastCrossMs = MeasureMs([&]() { for (ISinger* p : performers) fastCross += FastCast<IDancer>(p) != NULL; });
+EXPECT_TRUE(dynamicDown == count / 2 && fastDown == dynamicDown && dynamicCross == fastCross);
+
+std::cout << "down cast ns - dynamic_cast: " << dynamicDownMs * 1e6 / count << " FastCast: " << fastDownMs * 1e6 / count << std::endl;
+std::cout << "sibling cast ns - dynamic_cast: " << dynamicCrossMs * 1e6 / count << " FastCast: " << fastCrossMs * 1e6 / count << std::endl;
+// dynamic_cast 는 type_info 를 따라 상속 트리를 탐색하고, 형제 개체로의 형변환은 구체 개체까지 
+//  올라갔다가 다시 내려오므로 더 느립니다. FastCast 는 어느 경우든 같은 시간이 걸립니다.
+
+/*      QueryInterface - 인터페이스에서 다른 인터페이스 얻기      */
+/*
+Dog 은 IEatable, IWalkable 을, Idol 은 ISinger, IDancer 를 구현합니다. IEatable* 만 가진 
+    쪽에서 IWalkable* 를 얻으려면 dynamic_cast 로 형제 개체 형변환을 해야 합니다. 
+    인터페이스는 protected Non-Virtual 소멸자여서 소유권을 넘기거나 다형 소멸할수도 없습니다.
+    COM 의 QueryInterface 처럼 인터페이스가 다른 인터페이스를 직접 찾아 주도록 할수 있습니다.
+
+    1. 인터페이스마다 고유한 InterfaceId 를 가집니다. InterfaceTag<I>::s_Tag 는 인터페이스 
+        타입마다 따로 있는 정적 변수이므로, 그 주소는 서로 겹칠수 없습니다. 이름을 해시하는 
+        방식과 달리 충돌하지 않고, 인터페이스에 id 를 직접 적을 필요도 없습니다.
+    2. IQueryable 은 QueryInterface(id) 순가상 함수를 가진 인터페이스입니다. 다른 
+        인터페이스들이 상속합니다. 다른 인터페이스와 마찬가지로 protected Non-Virtual 
+        소멸자 입니다.
+    3. Implements<Derived, Interfaces...> 는 Interfaces 를 상속하고 QueryInterface(id) 를 
+        구현합니다. Interfaces 마다 id 를 비교하고 static_cast 하는 코드를 컴파일 타임에 
+        펼치므로, 부모 개체까지의 거리 (offset) 가 상수로 들어간 비교/덧셈 몇개가 됩니다. 
+        RTTI 를 사용하지 않고, 런타임에 표를 만들지도 않습니다. id 는 링크 타임 상수 주소여서 
+        비교는 상수와의 비교가 됩니다.
+    4. QueryInterface<I>(p) 는 p 가 가리키는 개체가 I 를 구현하면 I* 를, 아니면 NULL 을 
+        돌려줍니다. 돌려받은 포인터는 소유권이 없고, 개체보다 오래 사용하면 안됩니다.
+*/
+#include <type_traits>
+
+// #1.
+typedef const void* InterfaceId;
+template<typename I>
+struct InterfaceTag {
+    static const char s_Tag; // 값은 사용하지 않고 주소만 사용합니다.
+};
+template<typename I>
+const char InterfaceTag<I>::s_Tag = 0;
+
+template<typename I>
+constexpr InterfaceId GetInterfaceId() { return &InterfaceTag<I>::s_Tag; }
+
+// #2.
+class IQueryable {
+protected:
+    ~IQueryable() {}
+public:
+    virtual void* QueryInterface(InterfaceId id) = 0;
+};
+
+// #3.
+template<typename Derived, typename... Interfaces>
+class Implements : public Interfaces... {
+public:
+    // 모든 Interfaces 의 IQueryable::QueryInterface() 를 구현합니다.
+    virtual void* QueryInterface(InterfaceId id) final {
+        Derived* self = static_cast<Derived*>(this);
+        void* result = NULL;
+        (void)((id == GetInterfaceId<Interfaces>() ? (result = static_cast<Interfaces*>(self), true) : false) || ...);
+        return result;
+    }
+};
+
+// #4.
+template<typename I, typename Source>
+I* QueryInterface(Source* source) {
+    static_assert(std::is_base_of<IQueryable, I>::value, "I must derive from IQueryable");
+    return source != NULL ? static_cast<I*>(source->QueryInterface(GetInterfaceId<I>())) : NULL;
+}
+
+class IEatable : public IQueryable {
+protected:
+    ~IEatable() {}
+public:
+    virtual void Eat() = 0;
+};
+class IWalkable : public IQueryable {
+protected:
+    ~IWalkable() {}
+public:
+    virtual int Walk() = 0;
+};
+class ISinger : public IQueryable {
+protected:
+    ~ISinger() {}
+public:
+    virtual void Sing() = 0;
+};
+class IDancer : public IQueryable {
+protected:
+    ~IDancer() {}
+public:
+    virtual int Dance() = 0;
+};
+
+class Dog : public Implements<Dog, IEatable, IWalkable> {
+    int m_Steps;
+public:
+    Dog() : m_Steps(0) {}
+    virtual void Eat() {}
+    virtual int Walk() { return ++m_Steps; }
+};
+class Idol : public Implements<Idol, ISinger, IDancer> {
+    int m_Moves;
+public:
+    Idol() : m_Moves(0) {}
+    virtual void Sing() {}
+    virtual int Dance() { return ++m_Moves; }
+};
+
+{
+    Dog dog;
+    IEatable* eatable = &dog;
+    IWalkable* walkable = QueryInterface<IWalkable>(eatable); // (0) 형제 인터페이스를 얻습니다.
+    EXPECT_TRUE(walkable == static_cast<IWalkable*>(&dog));
+    EXPECT_TRUE(QueryInterface<IEatable>(walkable) == eatable);
+    EXPECT_TRUE(QueryInterface<ISinger>(eatable) == NULL);     // (0) 구현하지 않은 인터페이스는 NULL 입니다.
+
+    Idol idol;
+    ISinger* singer = &idol;
+    IDancer* dancer = QueryInterface<IDancer>(singer);
+    EXPECT_TRUE(dancer == static_cast<IDancer*>(&idol) && dancer->Dance() == 1);
+    EXPECT_TRUE(QueryInterface<IWalkable>(singer) == NULL);
+
+    // delete walkable; // (x) IWalkable 의 소멸자가 protected. 소유권은 여전히 dog 에 있습니다.
+}
+
+/*      QueryInterface 측정 - 초당 인터페이스 이동 수      */
+// Dog 과 Idol 이 섞인 IQueryable 개체들에서 IEatable -> IWalkable -> IEatable ... 처럼 
+//  인터페이스를 옮겨 다니는 횟수를 초당으로 비교합니다. (dynamic_cast 의 형제 개체 형변환과 비교)
+const int count = 1000000;
+const int hops = 8; // 개체마다 이동 횟수
+std::vector<Dog> dogs(count / 2);
+std::vector<Idol> idols(count / 2);
+std::vector<IEatable*> eatables;
+std::vector<ISinger*> singers;
+for (int i = 0; i < count / 2; ++i) {
+    eatables.push_back(&dogs[i]);
+    singers.push_back(&idols[i]);
+}
+
+long long queryResult = 0, dynamicResult = 0;
+double queryMs = MeasureMs([&]() {
+    for (int i = 0; i < count / 2; ++i) {
+        IEatable* eatable = eatables[i];
+        ISinger* singer = singers[i];
+        for (int hop = 0; hop < hops / 2; ++hop) {
+            IWalkable* walkable = QueryInterface<IWalkable>(eatable);
+            queryResult += walkable->Walk();
+            eatable = QueryInterface<IEatable>(walkable);
+
+            IDancer* dancer = QueryInterface<IDancer>(singer);
+            queryResult += dancer->Dance();
+            singer = QueryInterface<ISinger>(dancer);
+        }
+    }
+});
+double dynamicMs = MeasureMs([&]() {
+    for (int i = 0; i < count / 2; ++i) {
+        IEatable* eatable = eatables[i];
+        ISinger* singer = singers[i];
+        for (int hop = 0; hop < hops / 2; ++hop) {
+            IWalkable* walkable = dynamic_cast<IWalkable*>(eatable);
+            dynamicResult += walkable->Walk();
+            eatable = dynamic_cast<IEatable*>(walkable);
+
+            IDancer* dancer = dynamic_cast<IDancer*>(singer);
+            dynamicResult += dancer->Dance();
+            singer = dynamic_cast<ISinger*>(dancer);
+        }
+    }
+});
+EXPECT_TRUE(queryResult + static_cast<long long>(count) * hops / 2 * (hops / 2) == dynamicResult); // 2번째는 Walk(), Dance() 가 이어서 증가합니다.
+
+const double hopCount = static_cast<double>(count) * hops;
+std::cout << "interface hops/s - QueryInterface: " << hopCount / (queryMs / 1000) 
+    << " dynamic_cast: " << hopCount / (dynamicMs / 1000) << std::endl;
+// QueryInterface 는 가상 함수 호출 1번과 인터페이스 수만큼의 정수 비교이고, 
+//  dynamic_cast 는 type_info 로 상속 트리를 탐색합니다.
+
+/*      CRTP 믹스인 - virtual 상속 없는 다이아몬드 대체      */
+/*
+다이아몬드 상속에서 Idol 은 Singer::Person::m_Age 와 Dancer::Person::m_Age 를 중복해서 
+    가집니다. virtual 상속으로 Person 을 1개로 만들면, 개체마다 가상 기반 클래스 포인터가 
+    추가되고, Singer* 나 Dancer* 로 Person 멤버에 접근할때마다 가상 함수 테이블에서 
+    Person 까지의 거리 (offset) 를 읽어야 합니다.
+
+CRTP (Curiously Recurring Template Pattern) 믹스인으로 기능만 따로 만들어 조립할수 있습니다.
+
+    1. Person 은 공유할 상태 (m_Age, m_Energy) 만 가집니다.
+    2. SingerMixin<Derived>, DancerMixin<Derived> 는 멤버 변수 없이 기능만 제공합니다. 
+        Self() 로 자신을 Derived 로 static_cast 하여 Person 의 멤버에 접근합니다. 
+        Derived 가 컴파일 타임에 정해지므로 Person 까지의 거리가 상수입니다.
+    3. 믹스인은 단독으로 생성되거나 다형 소멸되지 않으므로, protected 생성자와 
+        protected Non-Virtual 소멸자를 사용합니다.
+    4. Compose<Derived, State, Mixins...> 는 State 1개와 Mixins<Derived> 들을 상속합니다. 
+        virtual 상속이 없고, 믹스인은 빈 클래스여서 빈 기반 클래스 최적화 (EBO) 로 
+        sizeof(Idol) == sizeof(Person) 입니다. 
+        (MSVC 는 빈 기반 클래스가 여러개이면 __declspec(empty_bases) 가 필요합니다.)
+*/
+// #1.
+class Person {
+public:
+    int m_Age;
+    int m_Energy;
+    Person() : m_Age(0), m_Energy(0) {}
+};
+
+// #2, #3.
+template<typename Derived>
+class SingerMixin {
+protected:
+    SingerMixin() {}
+    ~SingerMixin() {}
+    Derived& Self() { return static_cast<Derived&>(*this); }
+public:
+    void Sing() { Self().m_Energy -= 1; }
+};
+template<typename Derived>
+class DancerMixin {
+protected:
+    DancerMixin() {}
+    ~DancerMixin() {}
+    Derived& Self() { return static_cast<Derived&>(*this); }
+public:
+    void Dance() { Self().m_Energy -= 2; }
+};
+
+// #4.
+template<typename Derived, typename State, template<typename> class... Mixins>
+class Compose : 
+    public State, 
+    public Mixins<Derived>... {};
+
+class Idol : public Compose<Idol, Person, SingerMixin, DancerMixin> {};
+
+{
+    Idol obj;
+    obj.m_Age = 10;     // (0) m_Age 는 1개여서 모호하지 않습니다.
+    obj.m_Energy = 100;
+    obj.Sing();
+    obj.Dance();
+    EXPECT_TRUE(obj.m_Energy == 97); // (0) Sing(), Dance() 가 같은 m_Energy 를 사용합니다.
+    EXPECT_TRUE(sizeof(Idol) == sizeof(Person));
+
+    SingerMixin<Idol>& singer = obj; // (0) 역할별로 참조할수 있습니다.
+    singer.Sing();
+    EXPECT_TRUE(obj.m_Energy == 96);
+}
+
+/*      CRTP 믹스인 측정 - sizeof 와 멤버 접근      */
+// 같은 기능을 다이아몬드 상속 (PlainIdol) 과 virtual 상속 (VirtualIdol) 으로 만들고, 
+//  sizeof 와, Singer 역할의 포인터로 Sing() 을 호출하는 시간을 비교합니다.
+class PlainPerson {
+public:
+    int m_Age;
+    int m_Energy;
+    PlainPerson() : m_Age(0), m_Energy(0) {}
+};
+class PlainSinger : public PlainPerson { public: void Sing() { m_Energy -= 1; } };
+class PlainDancer : public PlainPerson { public: void Dance() { m_Energy -= 2; } };
+class PlainIdol : public PlainSinger, public PlainDancer {}; // (~) m_Energy 가 2개여서 Sing(), Dance() 가 다른 값을 바꿉니다.
+
+class VirtualPerson {
+public:
+    int m_Age;
+    int m_Energy;
+    VirtualPerson() : m_Age(0), m_Energy(0) {}
+};
+class VirtualSinger : virtual public VirtualPerson { public: void Sing() { m_Energy -= 1; } };
+class VirtualDancer : virtual public VirtualPerson { public: void Dance() { m_Energy -= 2; } };
+class VirtualIdol : public VirtualSinger, public VirtualDancer {};
+
+std::cout << "sizeof - PlainIdol: " << sizeof(PlainIdol) << " VirtualIdol: " << sizeof(VirtualIdol) 
+    << " Idol(CRTP): " << sizeof(Idol) << std::endl;
+
+// Singer 역할의 포인터로 Sing() 을 반복합니다. 
+//  VirtualSinger* 는 구체 타입을 모르므로 Person 까지의 거리를 가상 함수 테이블에서 읽습니다.
+template<typename Singer>
+double MeasureSing(std::vector<Singer*>& singers, int repeat) {
+    return MeasureMs([&]() {
+        for (int r = 0; r < repeat; ++r) {
+            for (Singer* singer : singers) singer->Sing();
+        }
+    });
+}
+
+const int count = 1000000;
+const int repeat = 10;
+std::vector<PlainIdol> plainIdols(count);
+std::vector<VirtualIdol> virtualIdols(count);
+std::vector<Idol> idols(count);
+std::vector<PlainSinger*> plainSingers;
+std::vector<VirtualSinger*> virtualSingers;
+std::vector<SingerMixin<Idol>*> mixinSingers;
+for (int i = 0; i < count; ++i) {
+    plainSingers.push_back(&plainIdols[i]);
+    virtualSingers.push_back(&virtualIdols[i]);
+    mixinSingers.push_back(&idols[i]);
+}
+
+double plainMs = MeasureSing(plainSingers, repeat);
+double virtualMs = MeasureSing(virtualSingers, repeat);
+double mixinMs = MeasureSing(mixinSingers, repeat);
+EXPECT_TRUE(plainIdols[0].PlainSinger::m_Energy == -repeat && plainIdols[0].PlainDancer::m_Energy == 0); // (~) 중복된 상태
+EXPECT_TRUE(virtualIdols[0].m_Energy == -repeat && idols[0].m_Energy == -repeat);
+
+std::cout << "Sing() ns/call - plain diamond: " << plainMs * 1e6 / (count * repeat) 
+    << " virtual inheritance: " << virtualMs * 1e6 / (count * repeat) 
+    << " CRTP mixin: " << mixinMs * 1e6 / (count * repeat) << std::endl;
+// CRTP 믹스인은 다이아몬드 상속처럼 거리가 상수여서 빠르면서도, virtual 상속처럼 상태가 
+//  1개 입니다. 또한 vbase 포인터가 없어 개체가 작으므로 같은 캐시에 더 많이 들어갑니다.
+//  대신 Idol 들을 SingerMixin<Idol>* 처럼 구체 타입별로만 다룰수 있습니다. 여러 구체 타입을 
+//  함께 다루려면 ISinger 같은 인터페이스를 따로 상속하세요.